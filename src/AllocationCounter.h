@@ -0,0 +1,10 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+// Number of global operator new calls since startup, from any thread. The
+// difference between two frames shows whether the frame touched the heap.
+size_t heapAllocationCount();
+
+#endif
@@ -0,0 +1,475 @@
+#include "AssetLoader.h"
+#include "LinearArena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "stb_image.h"
+
+static int64_t microsecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+ImageData::~ImageData()
+{
+    if (pixels)
+        stbi_image_free(pixels);
+}
+
+ImageData::ImageData(ImageData &&other) noexcept
+    : pixels(other.pixels), width(other.width), height(other.height), channels(other.channels)
+{
+    other.pixels = nullptr;
+}
+
+ImageData &ImageData::operator=(ImageData &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (pixels)
+            stbi_image_free(pixels);
+        pixels = other.pixels;
+        width = other.width;
+        height = other.height;
+        channels = other.channels;
+        other.pixels = nullptr;
+    }
+    return *this;
+}
+
+// Parser scratch memory: one arena per loading thread, reset per file. The
+// whole file and the indexed attributes live there; only the de-indexed
+// vertex arrays handed to the upload are heap vectors.
+static LinearArena &scratchArena()
+{
+    static thread_local LinearArena arena(256 * 1024);
+    return arena;
+}
+
+static std::atomic<size_t> scratchHighWater{0};
+
+static void recordScratchUse(const LinearArena &arena)
+{
+    size_t used = arena.highWaterMark();
+    size_t previous = scratchHighWater.load();
+    while (used > previous && !scratchHighWater.compare_exchange_weak(previous, used))
+    {
+    }
+}
+
+// Reads the whole file into the arena, NUL-terminated.
+static const char *readFileToArena(const std::string &path, LinearArena &arena)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return nullptr;
+    size_t size = static_cast<size_t>(file.tellg());
+    char *text = arena.allocateArray<char>(size + 1);
+    file.seekg(0);
+    file.read(text, size);
+    text[size] = '\0';
+    return text;
+}
+
+static const char *nextLine(const char *p)
+{
+    while (*p && *p != '\n')
+        ++p;
+    return *p ? p + 1 : p;
+}
+
+// True when the line starts with the keyword followed by a blank.
+static bool hasKeyword(const char *line, const char *keyword, const char *&rest)
+{
+    while (*keyword)
+        if (*line++ != *keyword++)
+            return false;
+    if (*line != ' ' && *line != '\t')
+        return false;
+    rest = line;
+    return true;
+}
+
+static glm::vec3 readVec3(const char *p)
+{
+    char *end;
+    glm::vec3 v;
+    v.x = std::strtof(p, &end);
+    v.y = std::strtof(end, &end);
+    v.z = std::strtof(end, &end);
+    return v;
+}
+
+bool parseOBJ(const std::string &path, MeshData &mesh)
+{
+    LinearArena &arena = scratchArena();
+    arena.reset();
+    const char *text = readFileToArena(path, arena);
+    if (!text)
+    {
+        std::cerr << "Error opening OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    ArenaVector<glm::vec3> temp_positions(arena);
+    ArenaVector<glm::vec2> temp_uvs(arena);
+    ArenaVector<glm::vec3> temp_normals(arena);
+    ArenaVector<unsigned int> vertexIndices(arena), uvIndices(arena), normalIndices(arena);
+
+    for (const char *line = text; *line; line = nextLine(line))
+    {
+        while (*line == ' ' || *line == '\t')
+            ++line;
+
+        const char *rest;
+        if (hasKeyword(line, "v", rest))
+        {
+            temp_positions.push_back(readVec3(rest));
+        }
+        else if (hasKeyword(line, "vt", rest))
+        {
+            char *end;
+            glm::vec2 uv;
+            uv.x = std::strtof(rest, &end);
+            uv.y = std::strtof(end, &end);
+            temp_uvs.push_back(uv);
+        }
+        else if (hasKeyword(line, "vn", rest))
+        {
+            temp_normals.push_back(readVec3(rest));
+        }
+        else if (hasKeyword(line, "f", rest))
+        {
+            // Triangles with v/vt/vn corners.
+            char *end = const_cast<char *>(rest);
+            for (int i = 0; i < 3; ++i)
+            {
+                unsigned int v = std::strtoul(end, &end, 10);
+                if (*end == '/')
+                    ++end;
+                unsigned int vt = std::strtoul(end, &end, 10);
+                if (*end == '/')
+                    ++end;
+                unsigned int vn = std::strtoul(end, &end, 10);
+                vertexIndices.push_back(v - 1);
+                uvIndices.push_back(vt - 1);
+                normalIndices.push_back(vn - 1);
+            }
+        }
+    }
+
+    MeshBounds &localBounds = mesh.bounds;
+    localBounds = MeshBounds();
+    for (unsigned int index : vertexIndices)
+        localBounds.box.expand(temp_positions[index]);
+    if (localBounds.box.isValid())
+    {
+        localBounds.sphere.center = localBounds.box.center();
+        for (unsigned int index : vertexIndices)
+            localBounds.sphere.radius = std::max(localBounds.sphere.radius,
+                                                 glm::length(temp_positions[index] - localBounds.sphere.center));
+    }
+
+    mesh.vertexData.clear();
+    mesh.positionData.clear();
+    mesh.vertexData.reserve(vertexIndices.size() * 8);
+    mesh.positionData.reserve(vertexIndices.size() * 3);
+    for (size_t i = 0; i < vertexIndices.size(); ++i)
+    {
+        glm::vec3 pos = temp_positions[vertexIndices[i]];
+        glm::vec2 uv = temp_uvs[uvIndices[i]];
+        glm::vec3 norm = temp_normals[normalIndices[i]];
+
+        mesh.vertexData.insert(mesh.vertexData.end(), {pos.x, pos.y, pos.z, uv.x, uv.y, norm.x, norm.y, norm.z});
+        mesh.positionData.insert(mesh.positionData.end(), {pos.x, pos.y, pos.z});
+    }
+    mesh.vertexCount = static_cast<int>(vertexIndices.size());
+    mesh.loaded = true;
+    recordScratchUse(arena);
+    return true;
+}
+
+bool parseMTL(const std::string &path, glm::vec4 &coefficients)
+{
+    LinearArena &arena = scratchArena();
+    arena.reset();
+    const char *text = readFileToArena(path, arena);
+    if (!text)
+    {
+        std::cerr << "Failed to open MTL file: " << path << std::endl;
+        return false;
+    }
+
+    for (const char *line = text; *line; line = nextLine(line))
+    {
+        while (*line == ' ' || *line == '\t')
+            ++line;
+
+        const char *rest;
+        if (hasKeyword(line, "Ka", rest))
+        {
+            glm::vec3 ka = readVec3(rest);
+            coefficients.x = (ka.r + ka.g + ka.b) / 3.0f;
+        }
+        else if (hasKeyword(line, "Kd", rest))
+        {
+            glm::vec3 kd = readVec3(rest);
+            coefficients.y = (kd.r + kd.g + kd.b) / 3.0f;
+        }
+        else if (hasKeyword(line, "Ks", rest))
+        {
+            glm::vec3 ks = readVec3(rest);
+            coefficients.z = (ks.r + ks.g + ks.b) / 3.0f;
+        }
+        else if (hasKeyword(line, "Ns", rest))
+        {
+            coefficients.w = std::strtof(rest, nullptr);
+        }
+    }
+    recordScratchUse(arena);
+    return true;
+}
+
+bool decodeImage(const std::string &path, ImageData &image)
+{
+    // The flip flag is process-wide in stb_image; set it once before any decode.
+    static std::once_flag flipOnce;
+    std::call_once(flipOnce, []
+                   { stbi_set_flip_vertically_on_load(true); });
+
+    image = ImageData();
+    image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+    if (!image.pixels)
+    {
+        std::cerr << "Failed to load texture image: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseTrajectory(const std::string &path, SplinePath &trajectory)
+{
+    std::ifstream in(path);
+    if (!in.is_open())
+    {
+        std::cerr << "Erro ao abrir arquivo de trajetória: " << path << std::endl;
+        return false;
+    }
+
+    // Optional "bezier" or "catmull-rom" line; without it, 3k + 1 points
+    // make a Bezier path and any other count a Catmull-Rom one.
+    bool typeGiven = false;
+    SplineType type = SPLINE_BEZIER;
+    std::vector<glm::vec3> points, rotations;
+    int columns = 0;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream ss(line);
+        std::string first;
+        if (!(ss >> first) || first[0] == '#')
+            continue;
+        if (first == "bezier" || first == "catmull-rom")
+        {
+            typeGiven = true;
+            type = first == "bezier" ? SPLINE_BEZIER : SPLINE_CATMULL_ROM;
+            continue;
+        }
+
+        std::istringstream values(line);
+        float v[6];
+        int count = 0;
+        while (count < 6 && values >> v[count])
+            ++count;
+        std::string rest;
+        bool valid = (count == 3 || count == 6) && !(values >> rest) && (columns == 0 || count == columns);
+        if (!valid)
+        {
+            std::cerr << "Linha do arquivo mal formatada (" << path << "): " << line << std::endl;
+            return false;
+        }
+        columns = count;
+        points.emplace_back(v[0], v[1], v[2]);
+        if (count == 6)
+            rotations.emplace_back(v[3], v[4], v[5]);
+    }
+
+    if (!typeGiven)
+        type = points.size() >= 4 && (points.size() - 1) % 3 == 0 ? SPLINE_BEZIER : SPLINE_CATMULL_ROM;
+    if (!trajectory.build(type, points, rotations))
+    {
+        std::cerr << "Trajetória inválida: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void loadEntityAssetData(const EntityAssetRequest &request, EntityAssetData &data, AssetLoadTimings *timings)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!request.mtlFile.empty())
+    {
+        data.materialLoaded = parseMTL(request.mtlFile, data.material);
+        if (timings)
+            timings->mtlMicroseconds += microsecondsSince(start);
+    }
+
+    if (!request.objFile.empty())
+    {
+        start = std::chrono::steady_clock::now();
+        if (!parseOBJ(request.objFile, data.mesh))
+            std::cerr << "Failed to load model from " << request.objFile << std::endl;
+        if (timings)
+            timings->objMicroseconds += microsecondsSince(start);
+    }
+
+    if (!request.textureFile.empty())
+    {
+        start = std::chrono::steady_clock::now();
+        decodeImage(request.textureFile, data.image);
+        if (timings)
+            timings->imageMicroseconds += microsecondsSince(start);
+    }
+
+    if (!request.trajectoryFile.empty())
+    {
+        start = std::chrono::steady_clock::now();
+        parseTrajectory(request.trajectoryFile, data.trajectory);
+        if (timings)
+            timings->trajectoryMicroseconds += microsecondsSince(start);
+    }
+}
+
+void AssetLoader::start(unsigned int workerCount)
+{
+    stop();
+    if (workerCount == 0)
+        workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1; // 0 means unknown
+
+    stopping = false;
+    for (unsigned int i = 0; i < workerCount; ++i)
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+}
+
+void AssetLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void AssetLoader::enqueue(const EntityAssetRequest &request, Completion onReady, Started onStarted)
+{
+    if (inFlight.load() == 0)
+        firstEnqueue = std::chrono::steady_clock::now();
+
+    std::unique_ptr<Job> job(new Job());
+    job->request = request;
+    job->onReady = std::move(onReady);
+    job->onStarted = std::move(onStarted);
+    inFlight++;
+
+    if (workers.empty())
+    {
+        // No pool: load inline, still deferring the GL stage to pumpUploads().
+        if (job->onStarted)
+            job->onStarted();
+        loadEntityAssetData(job->request, job->data, &timings);
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(std::move(job));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queued.push_back(std::move(job));
+    }
+    queueReady.notify_one();
+}
+
+void AssetLoader::workerLoop()
+{
+    for (;;)
+    {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait(lock, [this]
+                            { return stopping || !queued.empty(); });
+            if (queued.empty())
+                return;
+            job = std::move(queued.front());
+            queued.pop_front();
+        }
+
+        if (job->onStarted)
+            job->onStarted();
+        loadEntityAssetData(job->request, job->data, &timings);
+
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(std::move(job));
+        }
+        completedReady.notify_one();
+    }
+}
+
+size_t AssetLoader::pumpUploads(size_t maxJobs)
+{
+    size_t done = 0;
+    while (done < maxJobs)
+    {
+        std::unique_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            if (completed.empty())
+                break;
+            job = std::move(completed.front());
+            completed.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        job->onReady(job->data);
+        timings.uploadMicroseconds += microsecondsSince(start);
+
+        ++done;
+        ++jobsCompleted;
+        if (--inFlight == 0)
+            wallMilliseconds += microsecondsSince(firstEnqueue) / 1000.0;
+    }
+    return done;
+}
+
+void AssetLoader::finish()
+{
+    while (inFlight.load() > 0)
+    {
+        {
+            std::unique_lock<std::mutex> lock(completedMutex);
+            completedReady.wait(lock, [this]
+                                { return !completed.empty(); });
+        }
+        pumpUploads();
+    }
+}
+
+void AssetLoader::printStats() const
+{
+    auto ms = [](const std::atomic<int64_t> &micros)
+    { return micros.load() / 1000.0; };
+    std::cout << "Asset loading: " << jobsCompleted << " entities on " << workers.size() << " workers, "
+              << wallMilliseconds << " ms wall | obj " << ms(timings.objMicroseconds) << " ms, mtl "
+              << ms(timings.mtlMicroseconds) << " ms, image " << ms(timings.imageMicroseconds) << " ms, trajectory "
+              << ms(timings.trajectoryMicroseconds) << " ms (summed over workers) | GL upload "
+              << ms(timings.uploadMicroseconds) << " ms | parser scratch high-water "
+              << scratchHighWater.load() / 1024.0 << " KB" << std::endl;
+}
@@ -0,0 +1,134 @@
+#ifndef ASSET_LOADER_H
+#define ASSET_LOADER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+#include "SplinePath.h"
+
+// Interleaved position/uv/normal vertices plus the position-only copy used
+// by the depth pre-pass, ready to upload.
+struct MeshData
+{
+    std::vector<GLfloat> vertexData;
+    std::vector<GLfloat> positionData;
+    MeshBounds bounds;
+    int vertexCount = 0;
+    bool loaded = false;
+};
+
+// Decoded 8-bit image; owns the stb_image allocation.
+struct ImageData
+{
+    unsigned char *pixels = nullptr;
+    int width = 0, height = 0, channels = 0;
+
+    ImageData() = default;
+    ~ImageData();
+    ImageData(ImageData &&other) noexcept;
+    ImageData &operator=(ImageData &&other) noexcept;
+    ImageData(const ImageData &) = delete;
+    ImageData &operator=(const ImageData &) = delete;
+};
+
+// Empty paths are skipped, so a request may reload only part of an entity.
+struct EntityAssetRequest
+{
+    std::string objFile, mtlFile, textureFile, trajectoryFile;
+};
+
+// Everything an entity needs from disk, parsed and decoded off the context thread.
+struct EntityAssetData
+{
+    MeshData mesh;
+    glm::vec4 material = glm::vec4(0.1f, 0.5f, 0.5f, 10.0f); // ka, kd, ks, shininess
+    bool materialLoaded = false;
+    ImageData image;
+    SplinePath trajectory;
+};
+
+struct AssetLoadTimings
+{
+    std::atomic<int64_t> objMicroseconds{0};
+    std::atomic<int64_t> mtlMicroseconds{0};
+    std::atomic<int64_t> imageMicroseconds{0};
+    std::atomic<int64_t> trajectoryMicroseconds{0};
+    std::atomic<int64_t> uploadMicroseconds{0};
+};
+
+// CPU stages, safe to call from any thread. Timings are optional.
+bool parseOBJ(const std::string &path, MeshData &mesh);
+bool parseMTL(const std::string &path, glm::vec4 &coefficients);
+bool decodeImage(const std::string &path, ImageData &image);
+bool parseTrajectory(const std::string &path, SplinePath &trajectory);
+void loadEntityAssetData(const EntityAssetRequest &request, EntityAssetData &data, AssetLoadTimings *timings = nullptr);
+
+// Two-stage loading pipeline. File I/O, parsing and image decoding run on a
+// pool of worker threads; finished jobs queue up until the context thread
+// calls pumpUploads(), which runs their completion (GL object creation and
+// uploads) there.
+class AssetLoader
+{
+public:
+    using Completion = std::function<void(EntityAssetData &)>;
+    using Started = std::function<void()>;
+
+    ~AssetLoader() { stop(); }
+
+    // Zero workers picks one per core, minus the context thread.
+    void start(unsigned int workerCount = 0);
+    void stop();
+
+    // onStarted, if given, runs on the worker right before the job is parsed.
+    void enqueue(const EntityAssetRequest &request, Completion onReady, Started onStarted = nullptr);
+
+    // Runs the completion of up to maxJobs finished jobs on the calling thread.
+    size_t pumpUploads(size_t maxJobs = SIZE_MAX);
+    // Blocks until every queued job is parsed and uploaded.
+    void finish();
+    size_t pendingJobs() const { return inFlight.load(); }
+
+    void printStats() const;
+
+private:
+    struct Job
+    {
+        EntityAssetRequest request;
+        EntityAssetData data;
+        Completion onReady;
+        Started onStarted;
+    };
+
+    std::vector<std::thread> workers;
+    bool stopping = false;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<std::unique_ptr<Job>> queued;
+
+    std::mutex completedMutex;
+    std::condition_variable completedReady;
+    std::deque<std::unique_ptr<Job>> completed;
+
+    std::atomic<size_t> inFlight{0};
+    size_t jobsCompleted = 0;
+
+    AssetLoadTimings timings;
+    std::chrono::steady_clock::time_point firstEnqueue;
+    double wallMilliseconds = 0.0;
+
+    void workerLoop();
+};
+
+#endif
@@ -0,0 +1,377 @@
+#include "AssetManager.h"
+#include "GLState.h"
+#include <iostream>
+
+AssetManager assetManager;
+
+static void uploadMesh(const MeshData &data, MeshRecord &outMesh)
+{
+    glGenVertexArrays(1, &outMesh.vao);
+    glGenBuffers(1, &outMesh.vertexBuffer);
+
+    glState.bindVertexArray(outMesh.vao);
+    glState.bindBuffer(GL_ARRAY_BUFFER, outMesh.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, data.vertexData.size() * sizeof(GLfloat), data.vertexData.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void *)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void *)(5 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+
+    // Tightly packed positions for the depth pre-pass.
+    glGenVertexArrays(1, &outMesh.depthVAO);
+    glGenBuffers(1, &outMesh.positionBuffer);
+
+    glState.bindVertexArray(outMesh.depthVAO);
+    glState.bindBuffer(GL_ARRAY_BUFFER, outMesh.positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, data.positionData.size() * sizeof(GLfloat), data.positionData.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (void *)0);
+    glEnableVertexAttribArray(0);
+
+    glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+    glState.bindVertexArray(0);
+
+    outMesh.bounds = data.bounds;
+    outMesh.vertexCount = data.vertexCount;
+}
+
+static GLuint uploadTexture(const ImageData &image)
+{
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+
+    GLenum format = GL_RGB;
+    if (image.channels == 1)
+        format = GL_RED;
+    else if (image.channels == 3)
+        format = GL_RGB;
+    else if (image.channels == 4)
+        format = GL_RGBA;
+
+    glState.bindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glState.bindTexture(GL_TEXTURE_2D, 0);
+    return textureID;
+}
+
+template <AssetType Type, typename Record>
+AssetHandle<Type> AssetManager::acquireSlot(Pool<Type, Record> &pool, const std::string &key, bool &created)
+{
+    AssetHandle<Type> handle;
+    auto found = pool.byKey.find(key);
+    created = found == pool.byKey.end();
+    if (!created)
+    {
+        handle.slot = found->second;
+    }
+    else if (!pool.freeSlots.empty())
+    {
+        handle.slot = pool.freeSlots.back();
+        pool.freeSlots.pop_back();
+    }
+    else
+    {
+        handle.slot = static_cast<uint32_t>(pool.slots.size());
+        pool.slots.emplace_back();
+    }
+
+    Slot<Record> &slot = pool.slots[handle.slot];
+    if (created)
+    {
+        slot.key = key;
+        slot.state = ASSET_QUEUED;
+        slot.cpuBytes = sizeof(Slot<Record>) + key.size();
+        slot.gpuBytes = 0;
+        pool.byKey[key] = handle.slot;
+    }
+    slot.refCount++;
+    handle.generation = slot.generation;
+    return handle;
+}
+
+template <AssetType Type, typename Record>
+AssetManager::Slot<Record> *AssetManager::current(Pool<Type, Record> &pool, AssetHandle<Type> handle)
+{
+    if (handle.slot >= pool.slots.size())
+        return nullptr;
+    Slot<Record> &slot = pool.slots[handle.slot];
+    return slot.generation == handle.generation && slot.refCount > 0 ? &slot : nullptr;
+}
+
+template <AssetType Type, typename Record>
+bool AssetManager::releaseSlot(Pool<Type, Record> &pool, AssetHandle<Type> handle, Record &released)
+{
+    Slot<Record> *slot = current(pool, handle);
+    if (!slot || --slot->refCount > 0)
+        return false;
+
+    released = std::move(slot->record);
+    slot->record = Record();
+    pool.byKey.erase(slot->key);
+    std::string().swap(slot->key);
+    slot->generation++; // stale handles and in-flight loads now miss
+    slot->cpuBytes = slot->gpuBytes = 0;
+    pool.freeSlots.push_back(handle.slot);
+    return true;
+}
+
+void AssetManager::requestLoad(const EntityAssetRequest &request, std::atomic<uint8_t> &state,
+                               std::function<void(EntityAssetData &)> onLoaded)
+{
+    // Workers only move QUEUED to LOADING; if the slot was recycled in the
+    // meantime, the new asset merely reports LOADING a little early.
+    auto started = [&state]
+    {
+        uint8_t queued = ASSET_QUEUED;
+        state.compare_exchange_strong(queued, ASSET_LOADING);
+    };
+
+    if (loader)
+    {
+        loader->enqueue(request, std::move(onLoaded), started);
+        return;
+    }
+    started();
+    EntityAssetData data;
+    loadEntityAssetData(request, data);
+    onLoaded(data);
+}
+
+MeshHandle AssetManager::acquireMesh(const std::string &path)
+{
+    if (path.empty())
+        return MeshHandle();
+
+    bool created;
+    MeshHandle handle = acquireSlot(meshes, path, created);
+    if (!created)
+        return handle;
+
+    EntityAssetRequest request;
+    request.objFile = path;
+    requestLoad(request, meshes.slots[handle.slot].state, [this, handle](EntityAssetData &data)
+                {
+        Slot<MeshRecord> *slot = current(meshes, handle);
+        if (!slot)
+            return; // released before it finished loading
+        if (!data.mesh.loaded)
+        {
+            slot->state = ASSET_FAILED;
+            return;
+        }
+        uploadMesh(data.mesh, slot->record);
+        slot->gpuBytes = (data.mesh.vertexData.size() + data.mesh.positionData.size()) * sizeof(GLfloat);
+        slot->state = ASSET_READY; });
+    return handle;
+}
+
+TextureHandle AssetManager::acquireTexture(const std::string &path)
+{
+    if (path.empty())
+        return TextureHandle();
+
+    bool created;
+    TextureHandle handle = acquireSlot(textures, path, created);
+    if (!created)
+        return handle;
+
+    EntityAssetRequest request;
+    request.textureFile = path;
+    requestLoad(request, textures.slots[handle.slot].state, [this, handle](EntityAssetData &data)
+                {
+        Slot<TextureRecord> *slot = current(textures, handle);
+        if (!slot)
+            return;
+        if (!data.image.pixels)
+        {
+            slot->state = ASSET_FAILED;
+            return;
+        }
+        slot->record.texture = uploadTexture(data.image);
+        // The mip chain adds a third on top of the base level.
+        slot->gpuBytes = size_t(data.image.width) * data.image.height * data.image.channels * 4 / 3;
+        slot->state = ASSET_READY; });
+    return handle;
+}
+
+TrajectoryHandle AssetManager::acquireTrajectory(const std::string &path)
+{
+    if (path.empty())
+        return TrajectoryHandle();
+
+    bool created;
+    TrajectoryHandle handle = acquireSlot(trajectories, path, created);
+    if (!created)
+        return handle;
+
+    EntityAssetRequest request;
+    request.trajectoryFile = path;
+    requestLoad(request, trajectories.slots[handle.slot].state, [this, handle](EntityAssetData &data)
+                {
+        Slot<TrajectoryRecord> *slot = current(trajectories, handle);
+        if (!slot)
+            return;
+        if (data.trajectory.empty())
+        {
+            slot->state = ASSET_FAILED;
+            return;
+        }
+        slot->record.path = std::move(data.trajectory);
+        slot->cpuBytes += slot->record.path.memoryBytes();
+        slot->state = ASSET_READY; });
+    return handle;
+}
+
+ProgramHandle AssetManager::acquireProgram(const std::string &name, const ProgramBuilder &build)
+{
+    bool created;
+    ProgramHandle handle = acquireSlot(programs, name, created);
+    if (created)
+    {
+        Slot<ProgramRecord> &slot = programs.slots[handle.slot];
+        slot.state = ASSET_LOADING;
+        slot.record.program = build();
+        slot.state = slot.record.program ? ASSET_READY : ASSET_FAILED;
+    }
+    return handle;
+}
+
+void AssetManager::release(MeshHandle handle)
+{
+    MeshRecord released;
+    if (!releaseSlot(meshes, handle, released))
+        return;
+    for (GLuint vao : {released.vao, released.depthVAO})
+        if (vao)
+            pendingDeletes.vertexArrays.push_back(vao);
+    for (GLuint buffer : {released.vertexBuffer, released.positionBuffer})
+        if (buffer)
+            pendingDeletes.buffers.push_back(buffer);
+}
+
+void AssetManager::release(TextureHandle handle)
+{
+    TextureRecord released;
+    if (releaseSlot(textures, handle, released) && released.texture)
+        pendingDeletes.textures.push_back(released.texture);
+}
+
+void AssetManager::release(ProgramHandle handle)
+{
+    ProgramRecord released;
+    if (releaseSlot(programs, handle, released) && released.program)
+        pendingDeletes.programs.push_back(released.program);
+}
+
+void AssetManager::release(TrajectoryHandle handle)
+{
+    TrajectoryRecord released;
+    releaseSlot(trajectories, handle, released);
+}
+
+void AssetManager::deleteBatch(DeletionBatch &batch)
+{
+    if (batch.fence)
+        glDeleteSync(batch.fence);
+    for (GLuint vao : batch.vertexArrays)
+        glState.deleteVertexArray(vao);
+    for (GLuint buffer : batch.buffers)
+        glState.deleteBuffer(buffer);
+    for (GLuint texture : batch.textures)
+        glState.deleteTexture(texture);
+    for (GLuint program : batch.programs)
+        glState.deleteProgram(program);
+    batch = DeletionBatch();
+}
+
+void AssetManager::endFrame()
+{
+    if (!pendingDeletes.empty())
+    {
+        pendingDeletes.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        fencedDeletes.push_back(std::move(pendingDeletes));
+        pendingDeletes = DeletionBatch();
+    }
+
+    // Batches retire in submission order; stop at the first still in use.
+    while (!fencedDeletes.empty())
+    {
+        GLenum result = glClientWaitSync(fencedDeletes.front().fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+            break;
+        deleteBatch(fencedDeletes.front());
+        fencedDeletes.pop_front();
+    }
+}
+
+void AssetManager::releaseAll()
+{
+    glFinish();
+    for (DeletionBatch &batch : fencedDeletes)
+        deleteBatch(batch);
+    fencedDeletes.clear();
+
+    for (auto &slot : meshes.slots)
+    {
+        for (GLuint vao : {slot.record.vao, slot.record.depthVAO})
+            if (vao)
+                pendingDeletes.vertexArrays.push_back(vao);
+        for (GLuint buffer : {slot.record.vertexBuffer, slot.record.positionBuffer})
+            if (buffer)
+                pendingDeletes.buffers.push_back(buffer);
+    }
+    for (auto &slot : textures.slots)
+        if (slot.record.texture)
+            pendingDeletes.textures.push_back(slot.record.texture);
+    for (auto &slot : programs.slots)
+        if (slot.record.program)
+            pendingDeletes.programs.push_back(slot.record.program);
+    deleteBatch(pendingDeletes);
+
+    meshes = Pool<ASSET_MESH, MeshRecord>();
+    textures = Pool<ASSET_TEXTURE, TextureRecord>();
+    programs = Pool<ASSET_PROGRAM, ProgramRecord>();
+    trajectories = Pool<ASSET_TRAJECTORY, TrajectoryRecord>();
+}
+
+template <typename SlotType>
+static void printPoolStats(const char *name, const std::deque<SlotType> &slots)
+{
+    size_t live = 0, references = 0, pending = 0, failed = 0, cpuBytes = 0, gpuBytes = 0;
+    for (const auto &slot : slots)
+    {
+        if (slot.refCount == 0)
+            continue;
+        ++live;
+        references += slot.refCount;
+        uint8_t state = slot.state.load();
+        if (state == ASSET_QUEUED || state == ASSET_LOADING)
+            ++pending;
+        else if (state == ASSET_FAILED)
+            ++failed;
+        cpuBytes += slot.cpuBytes;
+        gpuBytes += slot.gpuBytes;
+    }
+    std::cout << "  " << name << live << " live (" << pending << " loading, " << failed << " failed), " << references
+              << " refs, CPU " << cpuBytes / 1024.0 << " KB, GPU " << gpuBytes / 1024.0 << " KB" << std::endl;
+}
+
+void AssetManager::printStats() const
+{
+    std::cout << "Assets:" << std::endl;
+    printPoolStats("meshes       ", meshes.slots);
+    printPoolStats("textures     ", textures.slots);
+    printPoolStats("programs     ", programs.slots);
+    printPoolStats("trajectories ", trajectories.slots);
+    std::cout << "  " << fencedDeletes.size() << " deletion batches waiting on the GPU" << std::endl;
+}
@@ -0,0 +1,199 @@
+#ifndef ASSET_MANAGER_H
+#define ASSET_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "AssetLoader.h"
+#include "Bounds.h"
+
+enum AssetType
+{
+    ASSET_MESH,
+    ASSET_TEXTURE,
+    ASSET_PROGRAM,
+    ASSET_TRAJECTORY,
+    ASSET_TYPE_COUNT
+};
+
+enum AssetState : uint8_t
+{
+    ASSET_QUEUED,  // waiting for a loader worker
+    ASSET_LOADING, // being parsed, or waiting for its upload
+    ASSET_READY,
+    ASSET_FAILED
+};
+
+// Reference to a shared asset. Like EntityHandle, slots are reused with a
+// bumped generation, so a handle kept past its release is detected. The type
+// parameter keeps a texture handle from being passed where a mesh is expected.
+template <AssetType Type>
+struct AssetHandle
+{
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+
+    uint32_t slot = INVALID;
+    uint32_t generation = 0;
+
+    bool isValid() const { return slot != INVALID; }
+    bool operator==(const AssetHandle &other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const AssetHandle &other) const { return !(*this == other); }
+};
+
+using MeshHandle = AssetHandle<ASSET_MESH>;
+using TextureHandle = AssetHandle<ASSET_TEXTURE>;
+using ProgramHandle = AssetHandle<ASSET_PROGRAM>;
+using TrajectoryHandle = AssetHandle<ASSET_TRAJECTORY>;
+
+struct MeshRecord
+{
+    GLuint vao = 0;
+    GLuint depthVAO = 0;     // positions only
+    GLuint vertexBuffer = 0; // interleaved position/uv/normal
+    GLuint positionBuffer = 0;
+    int vertexCount = 0;
+    MeshBounds bounds;
+};
+
+struct TextureRecord
+{
+    GLuint texture = 0;
+};
+
+struct ProgramRecord
+{
+    GLuint program = 0;
+};
+
+struct TrajectoryRecord
+{
+    SplinePath path;
+};
+
+// Meshes, textures, programs and trajectories shared by every entity that
+// names the same file. Each acquire adds a reference and, for a new key,
+// queues the load through the AssetLoader; the last release frees the slot.
+// GL objects are not deleted right away but after a fence placed at the end
+// of the frame signals, so draws already submitted never see them vanish.
+// All methods run on the context thread.
+class AssetManager
+{
+public:
+    using ProgramBuilder = std::function<GLuint()>;
+
+    // Without a loader, assets are loaded synchronously on acquire.
+    void setLoader(AssetLoader *assetLoader) { loader = assetLoader; }
+
+    // An empty path yields an invalid handle, which resolves to an empty record.
+    MeshHandle acquireMesh(const std::string &path);
+    TextureHandle acquireTexture(const std::string &path);
+    TrajectoryHandle acquireTrajectory(const std::string &path);
+    // The program is built on first acquire of the name.
+    ProgramHandle acquireProgram(const std::string &name, const ProgramBuilder &build);
+
+    void release(MeshHandle handle);
+    void release(TextureHandle handle);
+    void release(ProgramHandle handle);
+    void release(TrajectoryHandle handle);
+
+    const MeshRecord &mesh(MeshHandle handle) const { return record(meshes, handle); }
+    const TextureRecord &texture(TextureHandle handle) const { return record(textures, handle); }
+    const ProgramRecord &program(ProgramHandle handle) const { return record(programs, handle); }
+    const TrajectoryRecord &trajectory(TrajectoryHandle handle) const { return record(trajectories, handle); }
+
+    AssetState state(MeshHandle handle) const { return stateOf(meshes, handle); }
+    AssetState state(TextureHandle handle) const { return stateOf(textures, handle); }
+    AssetState state(ProgramHandle handle) const { return stateOf(programs, handle); }
+    AssetState state(TrajectoryHandle handle) const { return stateOf(trajectories, handle); }
+
+    // Fences the releases since the last call behind every command submitted
+    // so far, and deletes the GL objects whose fence has signaled. Call once
+    // per frame.
+    void endFrame();
+    // Waits for the GPU and deletes everything, referenced or not (shutdown).
+    void releaseAll();
+
+    void printStats() const;
+
+private:
+    template <typename Record>
+    struct Slot
+    {
+        Record record;
+        std::string key;
+        uint32_t generation = 0;
+        uint32_t refCount = 0;
+        std::atomic<uint8_t> state{ASSET_QUEUED}; // advanced to LOADING from a worker
+        size_t cpuBytes = 0;
+        size_t gpuBytes = 0;
+    };
+
+    // Slots live in a deque so their addresses survive growth; workers hold
+    // a pointer to the state of the slot they are loading.
+    template <AssetType Type, typename Record>
+    struct Pool
+    {
+        std::deque<Slot<Record>> slots;
+        std::vector<uint32_t> freeSlots;
+        std::unordered_map<std::string, uint32_t> byKey;
+    };
+
+    // GL names whose last reference went away during one frame.
+    struct DeletionBatch
+    {
+        std::vector<GLuint> vertexArrays, buffers, textures, programs;
+        GLsync fence = nullptr;
+
+        bool empty() const { return vertexArrays.empty() && buffers.empty() && textures.empty() && programs.empty(); }
+    };
+
+    AssetLoader *loader = nullptr;
+
+    Pool<ASSET_MESH, MeshRecord> meshes;
+    Pool<ASSET_TEXTURE, TextureRecord> textures;
+    Pool<ASSET_PROGRAM, ProgramRecord> programs;
+    Pool<ASSET_TRAJECTORY, TrajectoryRecord> trajectories;
+
+    DeletionBatch pendingDeletes;
+    std::deque<DeletionBatch> fencedDeletes;
+
+    template <AssetType Type, typename Record>
+    static AssetHandle<Type> acquireSlot(Pool<Type, Record> &pool, const std::string &key, bool &created);
+    // Drops a reference; on the last one the slot is recycled and true returned.
+    template <AssetType Type, typename Record>
+    static bool releaseSlot(Pool<Type, Record> &pool, AssetHandle<Type> handle, Record &released);
+    template <AssetType Type, typename Record>
+    static Slot<Record> *current(Pool<Type, Record> &pool, AssetHandle<Type> handle);
+
+    template <AssetType Type, typename Record>
+    static const Record &record(const Pool<Type, Record> &pool, AssetHandle<Type> handle)
+    {
+        static const Record empty;
+        if (handle.slot >= pool.slots.size() || pool.slots[handle.slot].generation != handle.generation)
+            return empty;
+        return pool.slots[handle.slot].record;
+    }
+
+    template <AssetType Type, typename Record>
+    static AssetState stateOf(const Pool<Type, Record> &pool, AssetHandle<Type> handle)
+    {
+        if (handle.slot >= pool.slots.size() || pool.slots[handle.slot].generation != handle.generation)
+            return ASSET_FAILED;
+        return static_cast<AssetState>(pool.slots[handle.slot].state.load());
+    }
+
+    // Queues a worker load of the given request for the slot behind state.
+    void requestLoad(const EntityAssetRequest &request, std::atomic<uint8_t> &state,
+                     std::function<void(EntityAssetData &)> onLoaded);
+    void deleteBatch(DeletionBatch &batch);
+};
+
+extern AssetManager assetManager;
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <cfloat>
+#include <glm/glm.hpp>
+
+struct AABB
+{
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    void expand(const glm::vec3 &p)
+    {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void expand(const AABB &other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+    float surfaceArea() const
+    {
+        if (!isValid())
+            return 0.0f;
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    // Bounds of this box after an affine transform (Arvo's method).
+    AABB transformed(const glm::mat4 &m) const
+    {
+        glm::vec3 c = glm::vec3(m * glm::vec4(center(), 1.0f));
+        glm::vec3 e = extents();
+        glm::vec3 r;
+        for (int i = 0; i < 3; ++i)
+            r[i] = glm::abs(m[0][i]) * e.x + glm::abs(m[1][i]) * e.y + glm::abs(m[2][i]) * e.z;
+
+        AABB out;
+        out.min = c - r;
+        out.max = c + r;
+        return out;
+    }
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+struct MeshBounds
+{
+    AABB box;
+    BoundingSphere sphere;
+};
+
+// Planes are (normal, distance) with the normal pointing inside the frustum.
+struct Frustum
+{
+    enum Plane { LEFT, RIGHT, BOTTOM, TOP, NEAR_PLANE, FAR_PLANE, COUNT };
+    enum Containment { OUTSIDE, INTERSECTING, INSIDE };
+    glm::vec4 planes[COUNT];
+
+    bool intersectsSphere(const glm::vec3 &center, float radius) const
+    {
+        for (const glm::vec4 &p : planes)
+            if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius)
+                return false;
+        return true;
+    }
+
+    bool intersectsAABB(const AABB &box) const
+    {
+        return classifyAABB(box) != OUTSIDE;
+    }
+
+    Containment classifyAABB(const AABB &box) const
+    {
+        Containment result = INSIDE;
+        for (const glm::vec4 &p : planes)
+        {
+            glm::vec3 positive(p.x >= 0.0f ? box.max.x : box.min.x,
+                               p.y >= 0.0f ? box.max.y : box.min.y,
+                               p.z >= 0.0f ? box.max.z : box.min.z);
+            if (p.x * positive.x + p.y * positive.y + p.z * positive.z + p.w < 0.0f)
+                return OUTSIDE;
+
+            glm::vec3 negative(p.x >= 0.0f ? box.min.x : box.max.x,
+                               p.y >= 0.0f ? box.min.y : box.max.y,
+                               p.z >= 0.0f ? box.min.z : box.max.z);
+            if (p.x * negative.x + p.y * negative.y + p.z * negative.z + p.w < 0.0f)
+                result = INTERSECTING;
+        }
+        return result;
+    }
+};
+
+#endif
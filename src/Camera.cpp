@@ -14,6 +14,28 @@ glm::mat4 Camera::getViewMatrix() {
     return glm::lookAt(position, position + front, up);
 }
 
+Frustum Camera::extractFrustum(const glm::mat4 &viewProjection) {
+    // Gribb/Hartmann: each plane is a sum/difference of the matrix rows.
+    const glm::mat4 &m = viewProjection;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+    Frustum frustum;
+    frustum.planes[Frustum::LEFT] = row3 + row0;
+    frustum.planes[Frustum::RIGHT] = row3 - row0;
+    frustum.planes[Frustum::BOTTOM] = row3 + row1;
+    frustum.planes[Frustum::TOP] = row3 - row1;
+    frustum.planes[Frustum::NEAR_PLANE] = row3 + row2;
+    frustum.planes[Frustum::FAR_PLANE] = row3 - row2;
+
+    for (glm::vec4 &p : frustum.planes)
+        p /= glm::length(glm::vec3(p));
+
+    return frustum;
+}
+
 void Camera::processKeyboard(char direction) {
     if (direction == 'W')
         position += front * speed;
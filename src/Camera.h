@@ -1,6 +1,7 @@
 #pragma once
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include "Bounds.h"
 
 class Camera {
 public:
@@ -24,6 +25,8 @@ public:
 
     glm::mat4 getViewMatrix();
 
+    static Frustum extractFrustum(const glm::mat4 &viewProjection);
+
     void processKeyboard(char direction);
     void processMouseMovement(float xoffset, float yoffset);
 
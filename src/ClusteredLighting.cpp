@@ -0,0 +1,249 @@
+#include "ClusteredLighting.h"
+#include "Entity.h"
+#include "GLState.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+const char *const CLUSTERED_LIGHTING_GLSL = R"glsl(
+    uniform samplerBuffer lightData;     // two texels per light: position + radius, color
+    uniform usamplerBuffer clusterGrid;  // offset, count per cluster
+    uniform usamplerBuffer lightIndices;
+    layout(std140) uniform ClusterData {
+        uvec4 clusterGridSize;
+        vec4 clusterParams;
+    };
+
+    void clusteredPointLights(vec3 fragPos, vec3 norm, vec3 viewDir, float viewDepth, vec4 mat,
+                              out vec3 diffuse, out vec3 specular) {
+        diffuse = vec3(0.0);
+        specular = vec3(0.0);
+
+        uvec3 cell = uvec3(uvec2(gl_FragCoord.xy / clusterParams.xy),
+                           uint(max(log(viewDepth) * clusterParams.z - clusterParams.w, 0.0)));
+        cell = min(cell, clusterGridSize.xyz - 1u);
+        int cluster = int((cell.z * clusterGridSize.y + cell.y) * clusterGridSize.x + cell.x);
+        uvec2 range = texelFetch(clusterGrid, cluster).xy;
+
+        for (uint i = 0u; i < range.y; ++i) {
+            int light = int(texelFetch(lightIndices, int(range.x + i)).x);
+            vec4 positionRadius = texelFetch(lightData, 2 * light);
+            vec3 color = texelFetch(lightData, 2 * light + 1).rgb;
+
+            vec3 toLight = positionRadius.xyz - fragPos;
+            float distance = length(toLight);
+            float window = clamp(1.0 - pow(distance / positionRadius.w, 4.0), 0.0, 1.0);
+            float attenuation = window * window / (distance * distance + 1.0);
+            vec3 lightDir = toLight / max(distance, 1e-4);
+
+            diffuse += mat.y * max(dot(norm, lightDir), 0.0) * attenuation * color;
+            specular += mat.z * pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), mat.w) * attenuation * color;
+        }
+    }
+)glsl";
+
+static void uploadTextureBuffer(GLuint buffer, const void *data, size_t bytes)
+{
+    glState.bindBuffer(GL_TEXTURE_BUFFER, buffer);
+    // Orphan every upload; an empty list still needs valid storage behind the texture.
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bytes, 16), nullptr, GL_STREAM_DRAW);
+    if (bytes)
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+}
+
+static GLuint createBufferTexture(GLuint buffer, GLenum format)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glState.bindTexture(GL_TEXTURE_BUFFER, texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    return texture;
+}
+
+void ClusteredLighting::initialize()
+{
+    glGenBuffers(1, &lightBuffer);
+    glGenBuffers(1, &gridBuffer);
+    glGenBuffers(1, &indexBuffer);
+    uploadTextureBuffer(lightBuffer, nullptr, 0);
+    uploadTextureBuffer(gridBuffer, nullptr, 0);
+    uploadTextureBuffer(indexBuffer, nullptr, 0);
+
+    lightTexture = createBufferTexture(lightBuffer, GL_RGBA32F);
+    gridTexture = createBufferTexture(gridBuffer, GL_RG32UI);
+    indexTexture = createBufferTexture(indexBuffer, GL_R32UI);
+
+    slices.resize(SLICES);
+    setLights(lights);
+}
+
+void ClusteredLighting::release()
+{
+    for (GLuint *texture : {&lightTexture, &gridTexture, &indexTexture})
+    {
+        if (*texture)
+            glState.deleteTexture(*texture);
+        *texture = 0;
+    }
+    for (GLuint *buffer : {&lightBuffer, &gridBuffer, &indexBuffer})
+    {
+        if (*buffer)
+            glState.deleteBuffer(*buffer);
+        *buffer = 0;
+    }
+}
+
+void ClusteredLighting::setLights(const std::vector<PointLight> &newLights)
+{
+    lights = newLights;
+    if (!lightBuffer)
+        return;
+
+    std::vector<glm::vec4> texels;
+    texels.reserve(lights.size() * 2);
+    for (const PointLight &light : lights)
+    {
+        texels.emplace_back(light.position, light.radius);
+        texels.emplace_back(light.color, 0.0f);
+    }
+    uploadTextureBuffer(lightBuffer, texels.data(), texels.size() * sizeof(glm::vec4));
+}
+
+static int tileIndex(float ndc, int tiles)
+{
+    int index = static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * tiles));
+    return std::min(std::max(index, 0), tiles - 1);
+}
+
+void ClusteredLighting::binSlice(int slice)
+{
+    SliceBins &bins = slices[slice];
+    bins.pairs.clear();
+
+    float zNear = sliceNear[slice];
+    float zFar = sliceNear[slice + 1];
+    for (uint32_t i = 0; i < viewLights.size(); ++i)
+    {
+        const glm::vec4 &light = viewLights[i];
+        float depth = -light.z;
+        float radius = light.w;
+        if (depth + radius < zNear || depth - radius > zFar)
+            continue;
+
+        // Extremes of x/depth and y/depth over the light's box clipped to this slab.
+        float dMin = std::max(zNear, depth - radius);
+        float dMax = std::min(zFar, depth + radius);
+        float xMin = std::min((light.x - radius) / dMin, (light.x - radius) / dMax) / tanHalfX;
+        float xMax = std::max((light.x + radius) / dMin, (light.x + radius) / dMax) / tanHalfX;
+        float yMin = std::min((light.y - radius) / dMin, (light.y - radius) / dMax) / tanHalfY;
+        float yMax = std::max((light.y + radius) / dMin, (light.y + radius) / dMax) / tanHalfY;
+        if (xMax < -1.0f || xMin > 1.0f || yMax < -1.0f || yMin > 1.0f)
+            continue;
+
+        int x0 = tileIndex(xMin, TILES_X), x1 = tileIndex(xMax, TILES_X);
+        int y0 = tileIndex(yMin, TILES_Y), y1 = tileIndex(yMax, TILES_Y);
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                bins.pairs.emplace_back(y * TILES_X + x, i);
+    }
+
+    // Counting sort by tile; lights stay in ascending order within a tile.
+    std::fill(std::begin(bins.counts), std::end(bins.counts), 0u);
+    for (const auto &pair : bins.pairs)
+        bins.counts[pair.first]++;
+    uint32_t cursor[TILES_X * TILES_Y];
+    uint32_t offset = 0;
+    for (int tile = 0; tile < TILES_X * TILES_Y; ++tile)
+    {
+        bins.offsets[tile] = offset;
+        cursor[tile] = offset;
+        offset += bins.counts[tile];
+    }
+    bins.indices.resize(bins.pairs.size());
+    for (const auto &pair : bins.pairs)
+        bins.indices[cursor[pair.first]++] = pair.second;
+}
+
+void ClusteredLighting::update(const glm::mat4 &view, float fovY, float aspect, float nearPlane, float farPlane,
+                               int viewportWidth, int viewportHeight)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    tanHalfY = std::tan(fovY * 0.5f);
+    tanHalfX = tanHalfY * aspect;
+    float logRatio = std::log(farPlane / nearPlane);
+    sliceScale = SLICES / logRatio;
+    sliceBias = SLICES * std::log(nearPlane) / logRatio;
+    for (int k = 0; k <= SLICES; ++k)
+        sliceNear[k] = nearPlane * std::pow(farPlane / nearPlane, float(k) / SLICES);
+
+    viewLights.resize(lights.size());
+    for (size_t i = 0; i < lights.size(); ++i)
+        viewLights[i] = glm::vec4(glm::vec3(view * glm::vec4(lights[i].position, 1.0f)), lights[i].radius);
+
+    // Slices are independent, so each worker claims whole slices.
+    if (lights.size() < 64)
+    {
+        for (int slice = 0; slice < SLICES; ++slice)
+            binSlice(slice);
+    }
+    else
+    {
+        workerPool.parallelFor(SLICES, [this](unsigned int slice)
+                               { binSlice(static_cast<int>(slice)); });
+    }
+
+    clusterGrid.resize(CLUSTER_COUNT * 2);
+    lightIndices.clear();
+    maxLightsPerCluster = 0;
+    for (int slice = 0; slice < SLICES; ++slice)
+    {
+        const SliceBins &bins = slices[slice];
+        uint32_t base = static_cast<uint32_t>(lightIndices.size());
+        for (int tile = 0; tile < TILES_X * TILES_Y; ++tile)
+        {
+            size_t cluster = slice * TILES_X * TILES_Y + tile;
+            clusterGrid[cluster * 2] = base + bins.offsets[tile];
+            clusterGrid[cluster * 2 + 1] = bins.counts[tile];
+            maxLightsPerCluster = std::max(maxLightsPerCluster, bins.counts[tile]);
+        }
+        lightIndices.insert(lightIndices.end(), bins.indices.begin(), bins.indices.end());
+    }
+
+    uploadTextureBuffer(gridBuffer, clusterGrid.data(), clusterGrid.size() * sizeof(uint32_t));
+    uploadTextureBuffer(indexBuffer, lightIndices.data(), lightIndices.size() * sizeof(uint32_t));
+
+    clusterUniforms.gridSize = glm::uvec4(TILES_X, TILES_Y, SLICES, static_cast<uint32_t>(lights.size()));
+    clusterUniforms.params = glm::vec4(float(viewportWidth) / TILES_X, float(viewportHeight) / TILES_Y,
+                                       sliceScale, sliceBias);
+
+    lastBinMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ClusteredLighting::bind() const
+{
+    glState.bindTextureUnit(LIGHT_DATA_UNIT, GL_TEXTURE_BUFFER, lightTexture);
+    glState.bindTextureUnit(CLUSTER_GRID_UNIT, GL_TEXTURE_BUFFER, gridTexture);
+    glState.bindTextureUnit(LIGHT_INDEX_UNIT, GL_TEXTURE_BUFFER, indexTexture);
+}
+
+void ClusteredLighting::setupProgram(GLuint program)
+{
+    glState.useProgram(program);
+    glUniform1i(glGetUniformLocation(program, "lightData"), LIGHT_DATA_UNIT);
+    glUniform1i(glGetUniformLocation(program, "clusterGrid"), CLUSTER_GRID_UNIT);
+    glUniform1i(glGetUniformLocation(program, "lightIndices"), LIGHT_INDEX_UNIT);
+
+    GLuint index = glGetUniformBlockIndex(program, "ClusterData");
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, Entity::CLUSTER_UNIFORM_BINDING);
+}
+
+void ClusteredLighting::printStats() const
+{
+    std::cout << "Clustered lighting: " << lights.size() << " point lights, " << lightIndices.size()
+              << " cluster entries, max " << maxLightsPerCluster << " per cluster, binning "
+              << lastBinMilliseconds << " ms" << std::endl;
+}
@@ -0,0 +1,90 @@
+#ifndef CLUSTERED_LIGHTING_H
+#define CLUSTERED_LIGHTING_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+struct PointLight
+{
+    glm::vec3 position;
+    float radius;
+    glm::vec3 color; // already scaled by intensity
+};
+
+// std140 layout of the ClusterData uniform block.
+struct ClusterUniforms
+{
+    glm::uvec4 gridSize; // tiles x, tiles y, depth slices, light count
+    glm::vec4 params;    // tile width/height in pixels, log-depth slice scale and bias
+};
+
+// Clustered forward shading: point lights are binned on the CPU into a
+// view-space froxel grid (screen tiles x exponential depth slices), slices
+// spread over workerPool, and the per-cluster light lists are uploaded
+// as texture buffers, which also work on GL 4.1. Fragment shaders include
+// CLUSTERED_LIGHTING_GLSL and only loop over the lights of their cluster.
+class ClusteredLighting
+{
+public:
+    static constexpr int TILES_X = 16;
+    static constexpr int TILES_Y = 16;
+    static constexpr int SLICES = 24;
+    static constexpr int CLUSTER_COUNT = TILES_X * TILES_Y * SLICES;
+
+    static constexpr GLuint LIGHT_DATA_UNIT = 1;
+    static constexpr GLuint CLUSTER_GRID_UNIT = 2;
+    static constexpr GLuint LIGHT_INDEX_UNIT = 3;
+
+    void initialize();
+    void release();
+
+    void setLights(const std::vector<PointLight> &lights);
+    size_t lightCount() const { return lights.size(); }
+
+    // Bins the lights for this frame's camera and uploads the cluster lists.
+    void update(const glm::mat4 &view, float fovY, float aspect, float nearPlane, float farPlane,
+                int viewportWidth, int viewportHeight);
+    void bind() const;
+    const ClusterUniforms &uniforms() const { return clusterUniforms; }
+
+    // Points the program's samplers and ClusterData block at our bindings.
+    static void setupProgram(GLuint program);
+
+    void printStats() const;
+
+private:
+    struct SliceBins
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> pairs; // tile, light
+        std::vector<uint32_t> indices;
+        uint32_t offsets[TILES_X * TILES_Y];
+        uint32_t counts[TILES_X * TILES_Y];
+    };
+
+    std::vector<PointLight> lights;
+    std::vector<glm::vec4> viewLights; // view-space position, radius
+    std::vector<SliceBins> slices;
+    std::vector<uint32_t> clusterGrid; // offset, count per cluster
+    std::vector<uint32_t> lightIndices;
+    ClusterUniforms clusterUniforms = {};
+
+    float sliceNear[SLICES + 1];
+    float tanHalfX = 1.0f, tanHalfY = 1.0f;
+    float sliceScale = 1.0f, sliceBias = 0.0f;
+
+    GLuint lightBuffer = 0, gridBuffer = 0, indexBuffer = 0;
+    GLuint lightTexture = 0, gridTexture = 0, indexTexture = 0;
+
+    double lastBinMilliseconds = 0.0;
+    uint32_t maxLightsPerCluster = 0;
+
+    void binSlice(int slice);
+};
+
+// Declarations and the clusteredPointLights() helper, inserted right after
+// the #version line of every lit fragment shader.
+extern const char *const CLUSTERED_LIGHTING_GLSL;
+
+#endif
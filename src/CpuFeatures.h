@@ -0,0 +1,61 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// AVX2 kernels are compiled one function at a time, so the rest of the
+// program runs on any x86-64 CPU and the kernels are only called once
+// cpuHasAVX2() says so. CG_ENABLE_AVX2 (CMake option) compiles them in.
+//  - GCC/Clang: CG_AVX2_TARGET retargets the function to AVX2 + FMA.
+//  - MSVC: AVX2 intrinsics are available without /arch:AVX2.
+#if defined(CG_ENABLE_AVX2) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CG_AVX2_KERNELS
+#define CG_AVX2_TARGET __attribute__((target("avx2,fma")))
+#elif defined(CG_ENABLE_AVX2) && defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define CG_AVX2_KERNELS
+#define CG_AVX2_TARGET
+#endif
+
+#if defined(CG_AVX2_KERNELS)
+// Index of the lowest set bit of a non-zero movemask.
+static inline unsigned int lowestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+// AVX2 and FMA on the CPU, with the OS saving the YMM registers.
+inline bool cpuHasAVX2()
+{
+#if defined(CG_AVX2_KERNELS) && defined(_MSC_VER)
+    static const bool supported = []
+    {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool fma = (info[2] & (1 << 12)) != 0;
+        bool osSavesYMM = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        return fma && osSavesYMM && avx2;
+    }();
+    return supported;
+#elif defined(CG_AVX2_KERNELS)
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+#endif
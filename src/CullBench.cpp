@@ -0,0 +1,66 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Camera.h"
+#include "FrustumCuller.h"
+
+// Mede o tempo de frustum culling de N esferas (padrão: 100k).
+// Uso: CullBench [numObjetos] [repeticoes]
+
+template <typename Fn>
+static double measureMs(int repetitions, Fn &&fn)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        fn();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+    size_t objectCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 200;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.1f, 2.0f);
+
+    FrustumCuller culler;
+    culler.resize(objectCount);
+    for (size_t i = 0; i < objectCount; ++i)
+    {
+        BoundingSphere sphere;
+        sphere.center = glm::vec3(position(rng), position(rng), position(rng));
+        sphere.radius = radius(rng);
+        culler.setSphere(i, sphere);
+    }
+
+    Camera camera(glm::vec3(0.0f, 0.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(80.0f), 1.0f, 0.1f, 100.0f);
+    Frustum frustum = Camera::extractFrustum(projection * camera.getViewMatrix());
+
+    std::vector<uint32_t> visible;
+    visible.reserve(objectCount);
+
+    double scalarMs = measureMs(repetitions, [&]
+                                { visible.clear(); culler.cullScalar(frustum, visible); });
+    size_t scalarVisible = visible.size();
+
+    double simdMs = measureMs(repetitions, [&]
+                              { visible.clear(); culler.cull(frustum, visible); });
+
+    double per100k = 100000.0 / objectCount;
+    std::cout << "Objects: " << objectCount << " | visible: " << visible.size() << std::endl;
+    std::cout << "scalar: " << scalarMs * per100k << " ms per 100k objects" << std::endl;
+    std::cout << (FrustumCuller::hasSIMD() ? "AVX2:   " : "cull() (scalar fallback): ")
+              << simdMs * per100k << " ms per 100k objects" << std::endl;
+
+    if (scalarVisible != visible.size())
+        std::cerr << "Warning: scalar and SIMD paths disagree (" << scalarVisible << " vs " << visible.size() << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,262 @@
+#include "DeferredRenderer.h"
+#include "ClusteredLighting.h"
+#include "ShadowMapper.h"
+#include "Entity.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <glm/gtc/type_ptr.hpp>
+
+static const GLchar *geometryVertexSource = R"glsl(
+    #version 410 core
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec2 texCoord;
+    layout(location = 2) in vec3 normal;
+
+    layout(std140) uniform FrameData {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 camPos;
+    };
+    layout(std140) uniform ObjectData {
+        mat4 model;
+        vec4 material;
+    };
+
+    out vec2 TexCoord;
+    out vec3 Normal;
+
+    invariant gl_Position;
+
+    void main() {
+        vec3 FragPos = vec3(model * vec4(position, 1.0));
+        Normal = mat3(transpose(inverse(model))) * normal;
+        TexCoord = texCoord;
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+    }
+)glsl";
+
+static const GLchar *geometryFragmentSource = R"glsl(
+    #version 410 core
+    in vec2 TexCoord;
+    in vec3 Normal;
+
+    layout(location = 0) out vec4 gAlbedo;
+    layout(location = 1) out vec2 gNormal;
+    layout(location = 2) out vec4 gMaterial;
+
+    uniform sampler2D texture1;
+    layout(std140) uniform ObjectData {
+        mat4 model;
+        vec4 material;
+    };
+
+    vec2 encodeNormal(vec3 n) {
+        n /= abs(n.x) + abs(n.y) + abs(n.z);
+        if (n.z < 0.0)
+            n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        return n.xy;
+    }
+
+    void main() {
+        gAlbedo = vec4(texture(texture1, TexCoord).rgb, 1.0);
+        gNormal = encodeNormal(normalize(Normal));
+        gMaterial = vec4(material.xyz, material.w / 255.0);
+    }
+)glsl";
+
+static const GLchar *lightingVertexSource = R"glsl(
+    #version 410 core
+    void main() {
+        // Full-screen triangle without any vertex buffer.
+        vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    }
+)glsl";
+
+// Inserted after the version line and the clustered lighting and shadow declarations.
+static const GLchar *lightingFragmentSource = R"glsl(
+    out vec4 FragColor;
+
+    uniform sampler2D gAlbedo;
+    uniform sampler2D gNormal;
+    uniform sampler2D gMaterial;
+    uniform sampler2D gDepth;
+    uniform mat4 inverseViewProjection;
+    uniform vec2 viewportSize;
+
+    layout(std140) uniform FrameData {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 camPos;
+        mat4 lightViewProjection;
+    };
+
+    vec3 decodeNormal(vec2 f) {
+        vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+        float t = clamp(-n.z, 0.0, 1.0);
+        n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+        return normalize(n);
+    }
+
+    void main() {
+        ivec2 pixel = ivec2(gl_FragCoord.xy);
+        float depth = texelFetch(gDepth, pixel, 0).r;
+        if (depth == 1.0) {
+            FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+            return;
+        }
+
+        vec3 color = texelFetch(gAlbedo, pixel, 0).rgb;
+        vec3 norm = decodeNormal(texelFetch(gNormal, pixel, 0).xy);
+        vec4 packed = texelFetch(gMaterial, pixel, 0);
+        vec4 material = vec4(packed.xyz, packed.w * 255.0);
+
+        vec4 clip = vec4(gl_FragCoord.xy / viewportSize * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+        vec4 world = inverseViewProjection * clip;
+        vec3 FragPos = world.xyz / world.w;
+
+        vec3 lightColor = vec3(1.0);
+        vec3 ambient = material.x * lightColor;
+        vec3 lightDir = normalize(lightPos.xyz - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = material.y * diff * lightColor;
+        vec3 viewDir = normalize(camPos.xyz - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.w);
+        vec3 specular = material.z * spec * lightColor;
+
+        vec3 pointDiffuse, pointSpecular;
+        float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+        clusteredPointLights(FragPos, norm, viewDir, viewDepth, material, pointDiffuse, pointSpecular);
+
+        float shadow = shadowVisibility(lightViewProjection, FragPos, norm, lightDir);
+        vec3 result = (ambient + shadow * diffuse + pointDiffuse) * color + shadow * specular + pointSpecular;
+        FragColor = vec4(result, 1.0);
+    }
+)glsl";
+
+static GLuint createTarget(GLenum internalFormat, GLenum format, GLenum type, int width, int height)
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glState.bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+void DeferredRenderer::initialize(int w, int h)
+{
+    width = w;
+    height = h;
+
+    geometryProgram = buildShaderProgram(geometryVertexSource, geometryFragmentSource);
+    bindUniformBlock(geometryProgram, "FrameData", Entity::FRAME_UNIFORM_BINDING);
+    bindUniformBlock(geometryProgram, "ObjectData", Entity::OBJECT_UNIFORM_BINDING);
+    glState.useProgram(geometryProgram);
+    glUniform1i(glGetUniformLocation(geometryProgram, "texture1"), 0);
+
+    std::string fragmentSource = std::string("#version 410 core\n") + CLUSTERED_LIGHTING_GLSL + SHADOW_MAPPING_GLSL +
+                                 lightingFragmentSource;
+    lightingProgram = buildShaderProgram(lightingVertexSource, fragmentSource.c_str());
+    bindUniformBlock(lightingProgram, "FrameData", Entity::FRAME_UNIFORM_BINDING);
+    ClusteredLighting::setupProgram(lightingProgram);
+    ShadowMapper::setupProgram(lightingProgram);
+    glState.useProgram(lightingProgram);
+    const char *samplers[] = {"gAlbedo", "gNormal", "gMaterial", "gDepth"};
+    for (GLuint i = 0; i < 4; ++i)
+        glUniform1i(glGetUniformLocation(lightingProgram, samplers[i]), FIRST_GBUFFER_UNIT + i);
+
+    albedoTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+    normalTexture = createTarget(GL_RG16F, GL_RG, GL_FLOAT, width, height);
+    materialTexture = createTarget(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height);
+    depthTexture = createTarget(GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, width, height);
+    glState.bindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, materialTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    const GLenum drawBuffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
+    glDrawBuffers(3, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "G-buffer framebuffer is incomplete" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &fullscreenVAO);
+}
+
+void DeferredRenderer::release()
+{
+    for (GLuint *program : {&geometryProgram, &lightingProgram})
+    {
+        if (*program)
+            glState.deleteProgram(*program);
+        *program = 0;
+    }
+    for (GLuint *texture : {&albedoTexture, &normalTexture, &materialTexture, &depthTexture})
+    {
+        if (*texture)
+            glState.deleteTexture(*texture);
+        *texture = 0;
+    }
+    if (framebuffer)
+        glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+    if (fullscreenVAO)
+        glState.deleteVertexArray(fullscreenVAO);
+    fullscreenVAO = 0;
+}
+
+void DeferredRenderer::render(std::vector<Entity> &entities, const std::vector<uint32_t> &order,
+                              StreamRingBuffer &uniformRing, const glm::mat4 &viewProjection,
+                              GLuint targetFramebuffer, int viewportWidth, int viewportHeight)
+{
+    viewportWidth = std::min(viewportWidth, width);
+    viewportHeight = std::min(viewportHeight, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, viewportWidth, viewportHeight);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0, 0, viewportWidth, viewportHeight);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+
+    glState.useProgram(geometryProgram);
+    for (uint32_t index : order)
+        entities[index].drawGeometry(uniformRing);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glDisable(GL_DEPTH_TEST);
+
+    glState.useProgram(lightingProgram);
+    glUniformMatrix4fv(glGetUniformLocation(lightingProgram, "inverseViewProjection"), 1, GL_FALSE,
+                       glm::value_ptr(glm::inverse(viewProjection)));
+    glUniform2f(glGetUniformLocation(lightingProgram, "viewportSize"), (float)viewportWidth, (float)viewportHeight);
+    glState.bindTextureUnit(FIRST_GBUFFER_UNIT, GL_TEXTURE_2D, albedoTexture);
+    glState.bindTextureUnit(FIRST_GBUFFER_UNIT + 1, GL_TEXTURE_2D, normalTexture);
+    glState.bindTextureUnit(FIRST_GBUFFER_UNIT + 2, GL_TEXTURE_2D, materialTexture);
+    glState.bindTextureUnit(FIRST_GBUFFER_UNIT + 3, GL_TEXTURE_2D, depthTexture);
+    glState.bindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glState.countDrawCall();
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DeferredRenderer::printStats() const
+{
+    std::cout << "Deferred: G-buffer " << width << "x" << height << ", 12 bytes/pixel + 32-bit depth ("
+              << (width * height * 16) / (1024 * 1024) << " MiB)" << std::endl;
+}
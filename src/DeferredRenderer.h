@@ -0,0 +1,45 @@
+#ifndef DEFERRED_RENDERER_H
+#define DEFERRED_RENDERER_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Entity;
+class StreamRingBuffer;
+
+// Deferred alternative to Entity::draw. Geometry is rasterized once into a
+// 12 byte/pixel G-buffer plus depth:
+//   RT0 RGBA8  albedo
+//   RT1 RG16F  octahedral normal
+//   RT2 RGBA8  ka, kd, ks, shininess / 255
+// and a full-screen pass then shades every pixel once, reconstructing the
+// position from depth and reading the point lights from the clustered lists.
+class DeferredRenderer
+{
+public:
+    // Kept clear of the entity texture and the clustered lighting buffers.
+    static constexpr GLuint FIRST_GBUFFER_UNIT = 5;
+
+    void initialize(int width, int height);
+    void release();
+
+    // Expects FrameData, ClusterData and the light buffers to be bound already.
+    // Shades into the lower-left viewportWidth x viewportHeight of targetFramebuffer.
+    void render(std::vector<Entity> &entities, const std::vector<uint32_t> &order,
+                StreamRingBuffer &uniformRing, const glm::mat4 &viewProjection,
+                GLuint targetFramebuffer, int viewportWidth, int viewportHeight);
+
+    void printStats() const;
+
+private:
+    int width = 0, height = 0;
+
+    GLuint geometryProgram = 0, lightingProgram = 0;
+    GLuint framebuffer = 0;
+    GLuint albedoTexture = 0, normalTexture = 0, materialTexture = 0, depthTexture = 0;
+    GLuint fullscreenVAO = 0;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "DepthPrepass.h"
+#include "Entity.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include <iostream>
+
+// Must compute gl_Position exactly like Entity's vertex shader (both are
+// invariant) so the GL_EQUAL test in the shading pass matches.
+static const GLchar *depthVertexSource = R"glsl(
+    #version 410 core
+    layout(location = 0) in vec3 position;
+
+    layout(std140) uniform FrameData {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 camPos;
+    };
+    layout(std140) uniform ObjectData {
+        mat4 model;
+        vec4 material;
+    };
+
+    invariant gl_Position;
+
+    void main() {
+        vec3 FragPos = vec3(model * vec4(position, 1.0));
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+    }
+)glsl";
+
+static const GLchar *depthFragmentSource = R"glsl(
+    #version 410 core
+    void main() {
+    }
+)glsl";
+
+DepthPrepass::DepthPrepass()
+    : fragmentQuery(GL_FRAGMENT_SHADER_INVOCATIONS)
+{
+}
+
+void DepthPrepass::initialize()
+{
+    program = buildShaderProgram(depthVertexSource, depthFragmentSource);
+    bindUniformBlock(program, "FrameData", Entity::FRAME_UNIFORM_BINDING);
+    bindUniformBlock(program, "ObjectData", Entity::OBJECT_UNIFORM_BINDING);
+
+    if (glExt.pipelineStatistics)
+        fragmentQuery.initialize();
+}
+
+void DepthPrepass::release()
+{
+    if (program)
+        glState.deleteProgram(program);
+    program = 0;
+    fragmentQuery.release();
+}
+
+void DepthPrepass::renderDepth(std::vector<Entity> &entities, const std::vector<uint32_t> &order,
+                               StreamRingBuffer &uniformRing)
+{
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+
+    glState.useProgram(program);
+    for (uint32_t index : order)
+        entities[index].drawDepth(uniformRing);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void DepthPrepass::beginShading()
+{
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+}
+
+void DepthPrepass::endShading()
+{
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
+
+void DepthPrepass::beginStatistics()
+{
+    if (glExt.pipelineStatistics)
+        fragmentQuery.begin();
+}
+
+void DepthPrepass::endStatistics()
+{
+    if (glExt.pipelineStatistics)
+        fragmentQuery.end();
+}
+
+void DepthPrepass::printStats(bool enabled) const
+{
+    std::cout << "Depth pre-pass " << (enabled ? "on" : "off");
+    GLuint64 invocations;
+    if (glExt.pipelineStatistics && fragmentQuery.latest(invocations))
+        std::cout << " | fragment shader invocations: " << invocations;
+    else
+        std::cout << " | fragment shader invocations: n/a";
+    std::cout << std::endl;
+}
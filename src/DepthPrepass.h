@@ -0,0 +1,39 @@
+#ifndef DEPTH_PREPASS_H
+#define DEPTH_PREPASS_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include "GpuQueryRing.h"
+
+class Entity;
+class StreamRingBuffer;
+
+// Depth-only pass over the position stream of each entity, after which the
+// shading pass runs with GL_EQUAL and depth writes off, so the Phong fragment
+// shader only runs once per visible pixel.
+class DepthPrepass
+{
+public:
+    DepthPrepass();
+
+    void initialize();
+    void release();
+
+    void renderDepth(std::vector<Entity> &entities, const std::vector<uint32_t> &order,
+                     StreamRingBuffer &uniformRing);
+    void beginShading();
+    void endShading();
+
+    // Fragment shader invocations of the whole scene draw, when the driver
+    // exposes pipeline statistics queries.
+    void beginStatistics();
+    void endStatistics();
+    void printStats(bool enabled) const;
+
+private:
+    GLuint program = 0;
+    GpuQueryRing fragmentQuery;
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "DynamicResolution.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static const GLchar *upscaleVertexSource = R"glsl(
+    #version 410 core
+    void main() {
+        vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+        gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    }
+)glsl";
+
+static const GLchar *upscaleFragmentSource = R"glsl(
+    #version 410 core
+    out vec4 FragColor;
+
+    uniform sampler2D sceneColor;
+    uniform vec2 outputSize;
+    uniform vec2 uvScale;   // rendered sub-rectangle relative to the whole target
+    uniform float sharpness;
+
+    void main() {
+        vec2 texel = 1.0 / vec2(textureSize(sceneColor, 0));
+        // Stay half a texel inside the sub-rectangle so bilinear never reads stale texels.
+        vec2 uv = clamp(gl_FragCoord.xy / outputSize * uvScale, 0.5 * texel, uvScale - 0.5 * texel);
+
+        vec3 center = texture(sceneColor, uv).rgb;
+        vec3 left = texture(sceneColor, uv - vec2(texel.x, 0.0)).rgb;
+        vec3 right = texture(sceneColor, uv + vec2(texel.x, 0.0)).rgb;
+        vec3 down = texture(sceneColor, uv - vec2(0.0, texel.y)).rgb;
+        vec3 up = texture(sceneColor, uv + vec2(0.0, texel.y)).rgb;
+
+        // Unsharp mask limited to the neighbourhood range to avoid halos.
+        vec3 sharpened = center + sharpness * (4.0 * center - left - right - down - up);
+        vec3 low = min(center, min(min(left, right), min(down, up)));
+        vec3 high = max(center, max(max(left, right), max(down, up)));
+        FragColor = vec4(clamp(sharpened, low, high), 1.0);
+    }
+)glsl";
+
+void DynamicResolution::initialize(int w, int h)
+{
+    width = w;
+    height = h;
+
+    upscaleProgram = buildShaderProgram(upscaleVertexSource, upscaleFragmentSource);
+    glState.useProgram(upscaleProgram);
+    glUniform1i(glGetUniformLocation(upscaleProgram, "sceneColor"), 0);
+
+    glGenTextures(1, &colorTexture);
+    glState.bindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glState.bindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Dynamic resolution framebuffer is incomplete" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &fullscreenVAO);
+}
+
+void DynamicResolution::release()
+{
+    if (upscaleProgram)
+        glState.deleteProgram(upscaleProgram);
+    upscaleProgram = 0;
+    if (colorTexture)
+        glState.deleteTexture(colorTexture);
+    colorTexture = 0;
+    if (depthRenderbuffer)
+        glDeleteRenderbuffers(1, &depthRenderbuffer);
+    depthRenderbuffer = 0;
+    if (framebuffer)
+        glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+    if (fullscreenVAO)
+        glState.deleteVertexArray(fullscreenVAO);
+    fullscreenVAO = 0;
+}
+
+int DynamicResolution::viewportWidth() const
+{
+    return enabled ? std::max(1, static_cast<int>(width * scale)) : width;
+}
+
+int DynamicResolution::viewportHeight() const
+{
+    return enabled ? std::max(1, static_cast<int>(height * scale)) : height;
+}
+
+GLuint DynamicResolution::beginScene()
+{
+    GLuint target = enabled ? framebuffer : 0;
+    glBindFramebuffer(GL_FRAMEBUFFER, target);
+    glViewport(0, 0, viewportWidth(), viewportHeight());
+    if (enabled)
+    {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(0, 0, viewportWidth(), viewportHeight());
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+    }
+    return target;
+}
+
+void DynamicResolution::endScene()
+{
+    if (!enabled)
+        return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+
+    glState.useProgram(upscaleProgram);
+    glUniform2f(glGetUniformLocation(upscaleProgram, "outputSize"), (float)width, (float)height);
+    glUniform2f(glGetUniformLocation(upscaleProgram, "uvScale"),
+                float(viewportWidth()) / width, float(viewportHeight()) / height);
+    glUniform1f(glGetUniformLocation(upscaleProgram, "sharpness"), std::min(0.5f, 1.0f - scale));
+    glState.bindTextureUnit(0, GL_TEXTURE_2D, colorTexture);
+    glState.bindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glState.countDrawCall();
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+void DynamicResolution::update(double sceneMilliseconds)
+{
+    lastSceneMilliseconds = sceneMilliseconds;
+    if (!enabled || sceneMilliseconds <= 0.0)
+        return;
+
+    // GPU time scales with the pixel count, i.e. with scale^2. Timer results
+    // lag a few frames, so only a fraction of the correction is applied per
+    // frame, and a +-5% dead band keeps the scale from oscillating.
+    double ratio = targetMilliseconds / sceneMilliseconds;
+    if (ratio > 0.95 && ratio < 1.05)
+        return;
+    float step = static_cast<float>(std::pow(std::sqrt(ratio), 0.1));
+    scale = std::min(1.0f, std::max(MIN_SCALE, scale * step));
+}
+
+void DynamicResolution::printStats() const
+{
+    std::cout << "Dynamic resolution: " << (enabled ? "on" : "off") << ", " << viewportWidth() << "x"
+              << viewportHeight() << " of " << width << "x" << height << " (scale " << scale << "), scene "
+              << lastSceneMilliseconds << " ms for a " << targetMilliseconds << " ms target" << std::endl;
+}
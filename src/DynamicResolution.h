@@ -0,0 +1,48 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+
+// Offscreen scene target whose resolution follows the measured GPU time of
+// the scene pass. The target is allocated once at window size; scaling only
+// changes the viewport sub-rectangle that is rendered, which is afterwards
+// upscaled to the window with a bilinear fetch plus a light sharpening pass.
+class DynamicResolution
+{
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+
+    void initialize(int width, int height);
+    void release();
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+    void setTargetMilliseconds(float ms) { targetMilliseconds = ms; }
+
+    // Size of the region the scene is rendered into this frame.
+    int viewportWidth() const;
+    int viewportHeight() const;
+
+    // Binds the scene target (or the window when disabled), sets the viewport
+    // and clears it; returns the framebuffer that was bound.
+    GLuint beginScene();
+    // Upscales the sub-rectangle to the window.
+    void endScene();
+
+    // Feeds the latest GPU time of the scene pass to the scale controller.
+    void update(double sceneMilliseconds);
+
+    void printStats() const;
+
+private:
+    int width = 0, height = 0;
+    bool enabled = false;
+    float targetMilliseconds = 16.0f;
+    float scale = 1.0f;
+    double lastSceneMilliseconds = 0.0;
+
+    GLuint framebuffer = 0, colorTexture = 0, depthRenderbuffer = 0;
+    GLuint upscaleProgram = 0, fullscreenVAO = 0;
+};
+
+#endif
@@ -1,4 +1,10 @@
 #include "Entity.h"
+#include "StreamRingBuffer.h"
+#include "GLState.h"
+#include "ClusteredLighting.h"
+#include "ShadowMapper.h"
+#include "AssetLoader.h"
+#include "TrajectoryBatch.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -12,10 +18,6 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-glm::mat4 viewMatrix;
-glm::mat4 projectionMatrix;
-glm::vec3 camPos;
-
 Entity::Entity(float x, float y, float z,
                glm::vec3 baseColor,
                float initialScale,
@@ -23,290 +25,118 @@ Entity::Entity(float x, float y, float z,
                const std::string &mtlFilePath,
                const std::string &textureFilePath,
                glm::vec3 initialRotation)
-    : position(x, y, z), baseColor(baseColor), scaleFactor(initialScale),
-      rotateX(false), rotateY(false), rotateZ(false),
-      VAO(0), textureID(0), nVertices(0), shaderProgram(0),
-      objFilePath(objFilePath), mtlFilePath(mtlFilePath), textureFilePath(textureFilePath),
-      initialRotation(initialRotation),
-      ka(0.1f), kd(0.5f), ks(0.5f), shininess(10.0f)
-{
-}
-
-void Entity::setViewProjection(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &cameraPosition)
+    : handle(entityStore.create(glm::vec3(x, y, z), initialRotation, initialScale)),
+      baseColor(baseColor),
+      objFilePath(objFilePath), mtlFilePath(mtlFilePath), textureFilePath(textureFilePath)
 {
-    viewMatrix = view;
-    projectionMatrix = projection;
-    camPos = cameraPosition;
 }
 
-void Entity::initialize()
+void Entity::acquireAssets()
 {
-    loadMaterial(mtlFilePath);
-
-    VAO = loadModelWithTexture(objFilePath, mtlFilePath, textureFilePath, nVertices, textureID);
-    if (VAO == -1)
-    {
-        std::cerr << "Failed to load model from " << objFilePath << std::endl;
-    }
-    setupShaders();
+    uint32_t r = row();
+    entityStore.mesh[r] = assetManager.acquireMesh(objFilePath);
+    MaterialRecord &material = entityStore.material[r];
+    material.texture = assetManager.acquireTexture(textureFilePath);
+    material.program = assetManager.acquireProgram("entity", setupShaders);
+    setTrajectoryFile(trajectoryFilePath);
 }
 
-glm::vec3 cubicBezier(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float t)
+void Entity::initialize(EntityAssetData &data)
 {
-    float u = 1.0f - t;
-    return u * u * u * p0 +
-           3 * u * u * t * p1 +
-           3 * u * t * t * p2 +
-           t * t * t * p3;
+    if (data.materialLoaded)
+        entityStore.material[row()].coefficients = data.material;
 }
 
-void Entity::loadBezierControlPoints(const std::string &file)
+void Entity::changeAssets(const std::string &obj, const std::string &mtl, const std::string &texture,
+                          const std::string &trajectory)
 {
-    std::ifstream in(file);
-    if (!in.is_open())
-    {
-        std::cerr << "Erro ao abrir arquivo de curva Bézier: " << file << std::endl;
-        return;
-    }
-
-    bezierControlPoints.clear();
-    bezierRotations.clear();
-
-    std::string line;
-    while (std::getline(in, line))
-    {
-        std::istringstream ss(line);
-        float px, py, pz;
-        float rx, ry, rz;
-        if (ss >> px >> py >> pz >> rx >> ry >> rz)
-        {
-            bezierControlPoints.emplace_back(px, py, pz);
-            bezierRotations.emplace_back(rx, ry, rz);
-        }
-        else
-        {
-            std::cerr << "Linha do arquivo mal formatada: " << line << std::endl;
-        }
-    }
-
-    in.close();
-
-    if (bezierControlPoints.size() == 4 && bezierRotations.size() == 4)
+    uint32_t r = row();
+    if (obj != objFilePath)
     {
-        position = bezierControlPoints[0];
-        rotation = bezierRotations[0];
-        bezierT = 0.0f;
-        followBezier = true;
+        MeshHandle previous = entityStore.mesh[r];
+        entityStore.mesh[r] = assetManager.acquireMesh(obj);
+        assetManager.release(previous);
+        entityStore.markDirty(r);
     }
-    else
+    if (texture != textureFilePath)
     {
-        std::cerr << "São necessários exatamente 4 pontos de controle e 4 rotações para a curva Bézier." << std::endl;
+        MaterialRecord &material = entityStore.material[r];
+        TextureHandle previous = material.texture;
+        material.texture = assetManager.acquireTexture(texture);
+        assetManager.release(previous);
     }
+    if (trajectory != trajectoryFilePath)
+        setTrajectoryFile(trajectory);
+    setAssetPaths(obj, mtl, texture, trajectory);
 }
 
-void Entity::updateBezierTrajectory()
+void Entity::release()
 {
-    if (!followBezier || bezierControlPoints.size() != 4 || bezierRotations.size() != 4)
-        return;
-
-    position = cubicBezier(bezierControlPoints[0], bezierControlPoints[1],
-                           bezierControlPoints[2], bezierControlPoints[3], bezierT);
-
-    rotation = glm::radians(cubicBezier(bezierRotations[0], bezierRotations[1],
-                                        bezierRotations[2], bezierRotations[3], bezierT));
-
-    bezierT += bezierSpeed;
-    if (bezierT > 1.0f)
-        bezierT = 0.0f;
+    uint32_t r = row();
+    assetManager.release(entityStore.mesh[r]);
+    entityStore.mesh[r] = MeshHandle();
+    MaterialRecord &material = entityStore.material[r];
+    assetManager.release(material.texture);
+    assetManager.release(material.program);
+    material = MaterialRecord();
+    trajectoryBatch.remove(handle.slot);
+    assetManager.release(trajectory);
+    trajectory = TrajectoryHandle();
 }
 
-int Entity::loadModelWithTexture(const std::string &objFilePath,
-                                 const std::string &mtlFilePath,
-                                 const std::string &textureFilePath,
-                                 int &outVertices,
-                                 GLuint &outTextureID)
+void Entity::setAssetPaths(const std::string &obj, const std::string &mtl, const std::string &texture,
+                           const std::string &trajectory)
 {
-    std::vector<glm::vec3> temp_positions;
-    std::vector<glm::vec2> temp_uvs;
-    std::vector<glm::vec3> temp_normals;
-    std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-
-    std::ifstream file(objFilePath);
-    if (!file.is_open())
-    {
-        std::cerr << "Error opening OBJ file: " << objFilePath << std::endl;
-        return -1;
-    }
-
-    std::string line;
-    while (std::getline(file, line))
-    {
-        std::istringstream ss(line);
-        std::string prefix;
-        ss >> prefix;
-
-        if (prefix == "v")
-        {
-            glm::vec3 pos;
-            ss >> pos.x >> pos.y >> pos.z;
-            temp_positions.push_back(pos);
-        }
-        else if (prefix == "vt")
-        {
-            glm::vec2 uv;
-            ss >> uv.x >> uv.y;
-            temp_uvs.push_back(uv);
-        }
-        else if (prefix == "vn")
-        {
-            glm::vec3 norm;
-            ss >> norm.x >> norm.y >> norm.z;
-            temp_normals.push_back(norm);
-        }
-        else if (prefix == "f")
-        {
-            for (int i = 0; i < 3; ++i)
-            {
-                std::string vertexStr;
-                ss >> vertexStr;
-                std::replace(vertexStr.begin(), vertexStr.end(), '/', ' ');
-                std::istringstream viss(vertexStr);
-                unsigned int v, vt, vn;
-                viss >> v >> vt >> vn;
-                vertexIndices.push_back(v - 1);
-                uvIndices.push_back(vt - 1);
-                normalIndices.push_back(vn - 1);
-            }
-        }
-    }
-    file.close();
-
-    std::vector<GLfloat> vertexData;
-    for (size_t i = 0; i < vertexIndices.size(); ++i)
-    {
-        glm::vec3 pos = temp_positions[vertexIndices[i]];
-        glm::vec2 uv = temp_uvs[uvIndices[i]];
-        glm::vec3 norm = temp_normals[normalIndices[i]];
-
-        vertexData.insert(vertexData.end(), {pos.x, pos.y, pos.z, uv.x, uv.y, norm.x, norm.y, norm.z});
-    }
+    objFilePath = obj;
+    mtlFilePath = mtl;
+    textureFilePath = texture;
+    trajectoryFilePath = trajectory;
+}
 
-    if (!textureFilePath.empty())
+void Entity::setTrajectoryFile(const std::string &file)
+{
+    TrajectoryHandle previous = trajectory;
+    trajectory = assetManager.acquireTrajectory(file);
+    assetManager.release(previous);
+    trajectoryFilePath = file;
+
+    // The lane reads the shared record in place; it waits while that loads.
+    uint32_t r = row();
+    if (trajectory.isValid())
     {
-        outTextureID = loadTexture(textureFilePath);
-        if (outTextureID == 0)
-        {
-            std::cerr << "Failed to load texture: " << textureFilePath << std::endl;
-        }
+        entityStore.flags[r] |= ENTITY_FOLLOW_BEZIER | ENTITY_TRANSFORM_DIRTY;
+        trajectoryBatch.add(handle.slot, &assetManager.trajectory(trajectory).path, trajectorySpeed);
     }
     else
     {
-        outTextureID = 0;
+        entityStore.flags[r] &= ~ENTITY_FOLLOW_BEZIER;
+        trajectoryBatch.remove(handle.slot);
     }
-
-    GLuint VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(GLfloat), vertexData.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void *)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void *)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (void *)(5 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    outVertices = (int)(vertexIndices.size());
-    return VAO;
+    entityStore.markDirty(r);
 }
 
-void Entity::loadMaterial(const std::string &mtlFilePath)
+void Entity::clearBezierTrajectory()
 {
-    std::ifstream file(mtlFilePath);
-    if (!file.is_open())
-    {
-        std::cerr << "Failed to open MTL file: " << mtlFilePath << std::endl;
-        return;
-    }
-
-    std::string line;
-    while (std::getline(file, line))
-    {
-        std::istringstream ss(line);
-        std::string prefix;
-        ss >> prefix;
-
-        if (prefix == "Ka")
-        {
-            float r, g, b;
-            ss >> r >> g >> b;
-            ka = (r + g + b) / 3.0f;
-        }
-        else if (prefix == "Kd")
-        {
-            float r, g, b;
-            ss >> r >> g >> b;
-            kd = (r + g + b) / 3.0f;
-        }
-        else if (prefix == "Ks")
-        {
-            float r, g, b;
-            ss >> r >> g >> b;
-            ks = (r + g + b) / 3.0f;
-        }
-        else if (prefix == "Ns")
-        {
-            ss >> shininess;
-        }
-    }
-
-    file.close();
+    setTrajectoryFile("");
 }
 
-GLuint Entity::loadTexture(const std::string &texturePath)
+void Entity::setTrajectorySpeed(float unitsPerSecond)
 {
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
-    if (!data)
-    {
-        std::cerr << "Failed to load texture image: " << texturePath << std::endl;
-        return 0;
-    }
-
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-
-    GLenum format = GL_RGB;
-    if (nrChannels == 1)
-        format = GL_RED;
-    else if (nrChannels == 3)
-        format = GL_RGB;
-    else if (nrChannels == 4)
-        format = GL_RGBA;
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    stbi_image_free(data);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    trajectorySpeed = unitsPerSecond;
+    trajectoryBatch.setSpeed(handle.slot, unitsPerSecond);
+}
 
-    return textureID;
+bool Entity::trajectoryFailed()
+{
+    if (assetManager.state(trajectory) != ASSET_FAILED)
+        return false;
+    std::cerr << "Trajetória não carregada: " << trajectoryFilePath << std::endl;
+    trajectoryBatch.remove(handle.slot);
+    entityStore.flags[row()] &= ~ENTITY_FOLLOW_BEZIER;
+    return true;
 }
 
-void Entity::setupShaders()
+GLuint Entity::setupShaders()
 {
     const GLchar *vertexShaderSource = R"glsl(
         #version 410 core
@@ -314,14 +144,24 @@ void Entity::setupShaders()
         layout(location = 1) in vec2 texCoord;
         layout(location = 2) in vec3 normal;
 
-        uniform mat4 model;
-        uniform mat4 view;
-        uniform mat4 projection;
+        layout(std140) uniform FrameData {
+            mat4 view;
+            mat4 projection;
+            vec4 lightPos;
+            vec4 camPos;
+            mat4 lightViewProjection;
+        };
+        layout(std140) uniform ObjectData {
+            mat4 model;
+            vec4 material;
+        };
 
         out vec2 TexCoord;
         out vec3 FragPos;
         out vec3 Normal;
 
+        invariant gl_Position;
+
         void main() {
             FragPos = vec3(model * vec4(position, 1.0));
             Normal = mat3(transpose(inverse(model))) * normal;
@@ -330,8 +170,8 @@ void Entity::setupShaders()
         }
     )glsl";
 
+    // Inserted after the version line and the clustered lighting and shadow declarations.
     const GLchar *fragmentShaderSource = R"glsl(
-        #version 410 core
         in vec2 TexCoord;
         in vec3 FragPos;
         in vec3 Normal;
@@ -339,29 +179,41 @@ void Entity::setupShaders()
         out vec4 FragColor;
 
         uniform sampler2D texture1;
-        uniform vec3 lightPos;
-        uniform vec3 camPos;
-        uniform float ka;
-        uniform float kd;
-        uniform float ks;
-        uniform float q;
+        layout(std140) uniform FrameData {
+            mat4 view;
+            mat4 projection;
+            vec4 lightPos;
+            vec4 camPos;
+            mat4 lightViewProjection;
+        };
+        layout(std140) uniform ObjectData {
+            mat4 model;
+            vec4 material;
+        };
 
         void main() {
             vec3 color = texture(texture1, TexCoord).rgb;
             vec3 norm = normalize(Normal);
             vec3 lightColor = vec3(1.0);
-            vec3 ambient = ka * lightColor;
-            vec3 lightDir = normalize(lightPos - FragPos);
+            vec3 ambient = material.x * lightColor;
+            vec3 lightDir = normalize(lightPos.xyz - FragPos);
             float diff = max(dot(norm, lightDir), 0.0);
-            vec3 diffuse = kd * diff * lightColor;
-            vec3 viewDir = normalize(camPos - FragPos);
+            vec3 diffuse = material.y * diff * lightColor;
+            vec3 viewDir = normalize(camPos.xyz - FragPos);
             vec3 reflectDir = reflect(-lightDir, norm);
-            float spec = pow(max(dot(viewDir, reflectDir), 0.0), q);
-            vec3 specular = ks * spec * lightColor;
-            vec3 result = (ambient + diffuse) * color + specular;
+            float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.w);
+            vec3 specular = material.z * spec * lightColor;
+
+            vec3 pointDiffuse, pointSpecular;
+            float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+            clusteredPointLights(FragPos, norm, viewDir, viewDepth, material, pointDiffuse, pointSpecular);
+
+            float shadow = shadowVisibility(lightViewProjection, FragPos, norm, lightDir);
+            vec3 result = (ambient + shadow * diffuse + pointDiffuse) * color + shadow * specular + pointSpecular;
             FragColor = vec4(result, 1.0);
         }
     )glsl";
+    const GLchar *fragmentSources[] = {"#version 410 core\n", CLUSTERED_LIGHTING_GLSL, SHADOW_MAPPING_GLSL, fragmentShaderSource};
 
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
@@ -369,11 +221,11 @@ void Entity::setupShaders()
     checkCompileErrors(vertexShader, "VERTEX");
 
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+    glShaderSource(fragmentShader, 4, fragmentSources, NULL);
     glCompileShader(fragmentShader);
     checkCompileErrors(fragmentShader, "FRAGMENT");
 
-    shaderProgram = glCreateProgram();
+    GLuint shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
     glLinkProgram(shaderProgram);
@@ -381,6 +233,15 @@ void Entity::setupShaders()
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+
+    glUniformBlockBinding(shaderProgram, glGetUniformBlockIndex(shaderProgram, "FrameData"), FRAME_UNIFORM_BINDING);
+    glUniformBlockBinding(shaderProgram, glGetUniformBlockIndex(shaderProgram, "ObjectData"), OBJECT_UNIFORM_BINDING);
+
+    glState.useProgram(shaderProgram);
+    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+    ClusteredLighting::setupProgram(shaderProgram);
+    ShadowMapper::setupProgram(shaderProgram);
+    return shaderProgram;
 }
 
 void Entity::checkCompileErrors(GLuint shader, std::string type)
@@ -409,93 +270,163 @@ void Entity::checkCompileErrors(GLuint shader, std::string type)
     }
 }
 
-void Entity::draw(const glm::vec3 &lightPosition)
+BoundingSphere Entity::getWorldBoundingSphere() const
 {
-    glUseProgram(shaderProgram);
+    BoundingSphere world;
+    uint32_t r = row();
+    const MeshBounds &localBounds = mesh().bounds;
+    const glm::mat4 &model = entityStore.model[r];
+    world.center = glm::vec3(model * glm::vec4(localBounds.sphere.center, 1.0f));
+    // Largest axis scale of the world matrix, which includes the ancestors' scale.
+    float axisScale = std::max(glm::length(glm::vec3(model[0])),
+                               std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    world.radius = localBounds.sphere.radius * axisScale;
+    return world;
+}
 
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-    model = glm::scale(model, glm::vec3(scaleFactor));
+bool Entity::assetsSettled() const
+{
+    auto settled = [](AssetState state)
+    { return state == ASSET_READY || state == ASSET_FAILED; };
+    uint32_t r = row();
+    return settled(assetManager.state(entityStore.mesh[r])) && settled(assetManager.state(material().texture)) &&
+           settled(assetManager.state(trajectory));
+}
 
-    if (followBezier)
-    {
-        model = glm::rotate(model, rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::rotate(model, rotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
-    }
-    else
+AABB Entity::getWorldAABB() const
+{
+    // A mesh that is not READY has no bounds yet; transforming the inverted
+    // default box would produce NaN, so pass on an empty box instead.
+    const AABB &local = mesh().bounds.box;
+    if (!local.isValid())
+        return AABB();
+    return local.transformed(getModelMatrix());
+}
+
+bool Entity::bindObjectUniforms(StreamRingBuffer &uniformRing)
+{
+    uint32_t r = row();
+    if (entityStore.uniformFrame[r] != uniformRing.frameNumber())
     {
-        model = glm::rotate(model, initialRotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, initialRotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
-        model = glm::rotate(model, initialRotation.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        ObjectUniforms *object = uniformRing.allocate<ObjectUniforms>(entityStore.uniformOffset[r]);
+        if (!object)
+            return false;
+
+        object->model = entityStore.model[r];
+        object->material = material().coefficients;
+        entityStore.uniformFrame[r] = uniformRing.frameNumber();
     }
 
-    
-    float angle = static_cast<float>(glfwGetTime());
-    if (rotateX)
-        model = glm::rotate(model, angle, glm::vec3(1.0f, 0.0f, 0.0f));
-    if (rotateY)
-        model = glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
-    if (rotateZ)
-        model = glm::rotate(model, angle, glm::vec3(0.0f, 0.0f, 1.0f));
-
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(viewMatrix));
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projectionMatrix));
-
-    glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), lightPosition.x, lightPosition.y, lightPosition.z);
-    glUniform3f(glGetUniformLocation(shaderProgram, "camPos"), camPos.x, camPos.y, camPos.z);
-    glUniform1f(glGetUniformLocation(shaderProgram, "ka"), ka);
-    glUniform1f(glGetUniformLocation(shaderProgram, "kd"), kd);
-    glUniform1f(glGetUniformLocation(shaderProgram, "ks"), ks);
-    glUniform1f(glGetUniformLocation(shaderProgram, "q"), shininess);
-
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glUniform1i(glGetUniformLocation(shaderProgram, "texture1"), 0);
+    uniformRing.bindRange(OBJECT_UNIFORM_BINDING, entityStore.uniformOffset[r], sizeof(ObjectUniforms));
+    return true;
+}
+
+void Entity::drawDepth(StreamRingBuffer &uniformRing)
+{
+    if (!bindObjectUniforms(uniformRing))
+        return;
+
+    const MeshRecord &m = mesh();
+    if (m.vertexCount == 0)
+        return;
+    glState.bindVertexArray(m.depthVAO);
+    glDrawArrays(GL_TRIANGLES, 0, m.vertexCount);
+    glState.countDrawCall();
+}
+
+void Entity::drawGeometry(StreamRingBuffer &uniformRing)
+{
+    if (!bindObjectUniforms(uniformRing))
+        return;
+
+    const MeshRecord &m = mesh();
+    if (m.vertexCount == 0)
+        return;
+    glState.bindTextureUnit(0, GL_TEXTURE_2D, getTexture());
+    glState.bindVertexArray(m.vao);
+    glDrawArrays(GL_TRIANGLES, 0, m.vertexCount);
+    glState.countDrawCall();
+}
+
+void Entity::draw(StreamRingBuffer &uniformRing)
+{
+    if (!bindObjectUniforms(uniformRing))
+        return;
 
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, nVertices);
-    glBindVertexArray(0);
+    const MeshRecord &m = mesh();
+    if (m.vertexCount == 0)
+        return; // mesh still loading
+    const MaterialRecord &mat = material();
+    glState.useProgram(assetManager.program(mat.program).program);
+    glState.bindTextureUnit(0, GL_TEXTURE_2D, assetManager.texture(mat.texture).texture);
+    glState.bindVertexArray(m.vao);
+    glDrawArrays(GL_TRIANGLES, 0, m.vertexCount);
+    glState.countDrawCall();
+}
+
+void Entity::toggleFlag(uint8_t flag)
+{
+    // Rotation axes are exclusive: enabling one turns the others off.
+    uint8_t &f = entityStore.flags[row()];
+    bool wasOn = f & flag;
+    f &= ~(ENTITY_ROTATE_X | ENTITY_ROTATE_Y | ENTITY_ROTATE_Z);
+    if (!wasOn)
+        f |= flag;
+    f |= ENTITY_TRANSFORM_DIRTY;
 }
 
 void Entity::toggleRotateX()
 {
-    rotateX = !rotateX;
-    rotateY = false;
-    rotateZ = false;
+    toggleFlag(ENTITY_ROTATE_X);
 }
 
 void Entity::toggleRotateY()
 {
-    rotateX = false;
-    rotateY = !rotateY;
-    rotateZ = false;
+    toggleFlag(ENTITY_ROTATE_Y);
 }
 
 void Entity::toggleRotateZ()
 {
-    rotateX = false;
-    rotateY = false;
-    rotateZ = !rotateZ;
+    toggleFlag(ENTITY_ROTATE_Z);
+}
+
+void Entity::setRotateAxis(char axis)
+{
+    uint8_t &f = entityStore.flags[row()];
+    f &= ~(ENTITY_ROTATE_X | ENTITY_ROTATE_Y | ENTITY_ROTATE_Z);
+    if (axis == 'x')
+        f |= ENTITY_ROTATE_X;
+    else if (axis == 'y')
+        f |= ENTITY_ROTATE_Y;
+    else if (axis == 'z')
+        f |= ENTITY_ROTATE_Z;
+    f |= ENTITY_TRANSFORM_DIRTY;
 }
 
 void Entity::scaleUp()
 {
-    scaleFactor = std::min(scaleFactor + 0.1f, 1.0f);
+    uint32_t r = row();
+    entityStore.scale[r] = std::min(entityStore.scale[r] + 0.1f, 1.0f);
+    entityStore.markDirty(r);
 }
 
 void Entity::scaleDown()
 {
-    scaleFactor = std::max(scaleFactor - 0.1f, 0.1f);
+    uint32_t r = row();
+    entityStore.scale[r] = std::max(entityStore.scale[r] - 0.1f, 0.1f);
+    entityStore.markDirty(r);
 }
 
 void Entity::moveForward()
 {
-    position.z -= TRANSLATION_SPEED;
+    uint32_t r = row();
+    entityStore.position[r].z -= TRANSLATION_SPEED;
+    entityStore.markDirty(r);
 }
 
 void Entity::moveBackward()
 {
-    position.z += TRANSLATION_SPEED;
-}
\ No newline at end of file
+    uint32_t r = row();
+    entityStore.position[r].z += TRANSLATION_SPEED;
+    entityStore.markDirty(r);
+}
@@ -6,10 +6,35 @@
 #include <glm/glm.hpp>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include "Bounds.h"
+#include "EntityStore.h"
+
+class StreamRingBuffer;
+struct EntityAssetData;
+
+// std140 layouts of the uniform blocks streamed through StreamRingBuffer.
+struct FrameUniforms
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 camPos;
+    glm::mat4 lightViewProjection;
+};
+
+struct ObjectUniforms
+{
+    glm::mat4 model;
+    glm::vec4 material; // ka, kd, ks, shininess
+};
 
 class Entity
 {
 public:
+    static constexpr GLuint FRAME_UNIFORM_BINDING = 0;
+    static constexpr GLuint OBJECT_UNIFORM_BINDING = 1;
+    static constexpr GLuint CLUSTER_UNIFORM_BINDING = 2;
+
     Entity(float x, float y, float z,
            glm::vec3 baseColor,
            float initialScale,
@@ -18,15 +43,63 @@ public:
            const std::string &textureFilePath,
            glm::vec3 initialRotation = glm::vec3(0.0f));
 
-    bool followBezier = false;
-
-    void initialize();
-    void draw(const glm::vec3 &lightPosition);
-    void setViewProjection(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &cameraPosition);
+    // An entity is one row with asset references, not the owner of GL
+    // objects; moving it keeps the references, copying would double them.
+    Entity(const Entity &) = delete;
+    Entity &operator=(const Entity &) = delete;
+    Entity(Entity &&) = default;
+    Entity &operator=(Entity &&) = default;
+
+    // Rotating or following a trajectory, i.e. moving every frame on its own.
+    bool isAnimated() const { return entityStore.flags[row()] & (ENTITY_ANIMATED | ENTITY_MOVING); }
+    bool followsBezier() const { return entityStore.flags[row()] & ENTITY_FOLLOW_BEZIER; }
+
+    // Acquires the shared mesh, texture, program and trajectory named by the
+    // asset paths; those not loaded yet stream in through assetManager.
+    void acquireAssets();
+    // Applies the per-entity data loaded by AssetLoader (the .mtl coefficients).
+    void initialize(EntityAssetData &data);
+    // Points the entity at new asset paths (hot reload). Changed assets are
+    // acquired before the old ones are released; the .mtl is left to the caller.
+    void changeAssets(const std::string &obj, const std::string &mtl, const std::string &texture,
+                      const std::string &trajectory);
+    // Drops this entity's asset references.
+    void release();
+    // True once the mesh, texture and trajectory are each READY or FAILED.
+    bool assetsSettled() const;
+    void draw(StreamRingBuffer &uniformRing);
+    // Position-only draw for the depth pre-pass; the caller binds the program.
+    void drawDepth(StreamRingBuffer &uniformRing);
+    // Full-attribute draw with the caller's program bound (deferred G-buffer pass).
+    void drawGeometry(StreamRingBuffer &uniformRing);
+
+    // Hot state lives in entityStore; these resolve the handle to its row.
+    EntityHandle getHandle() const { return handle; }
+    uint32_t row() const { return entityStore.row(handle); }
+    const glm::mat4 &getModelMatrix() const { return entityStore.model[row()]; }
+    const MeshBounds &getLocalBounds() const { return mesh().bounds; }
+    BoundingSphere getWorldBoundingSphere() const;
+    AABB getWorldAABB() const;
+
+    GLuint getVertexBuffer() const { return mesh().vertexBuffer; }
+    int getVertexCount() const { return mesh().vertexCount; }
+    GLuint getTexture() const { return assetManager.texture(material().texture).texture; }
+    glm::vec4 getMaterial() const { return material().coefficients; }
+    const std::string &getObjFilePath() const { return objFilePath; }
+    const std::string &getTextureFilePath() const { return textureFilePath; }
+    const std::string &getMtlFilePath() const { return mtlFilePath; }
+    const std::string &getTrajectoryFilePath() const { return trajectoryFilePath; }
+    void setAssetPaths(const std::string &obj, const std::string &mtl, const std::string &texture, const std::string &trajectory);
+
+    // Identity used to diff a reloaded scene: the entity's name, or its index in the file.
+    const std::string &getSceneKey() const { return sceneKey; }
+    void setSceneKey(const std::string &key) { sceneKey = key; }
 
     void toggleRotateX();
     void toggleRotateY();
     void toggleRotateZ();
+    // 'x', 'y' or 'z' starts spinning about that axis; anything else stops it.
+    void setRotateAxis(char axis);
 
     void scaleUp();
     void scaleDown();
@@ -34,47 +107,40 @@ public:
     void moveForward();
     void moveBackward();
 
-    void loadBezierControlPoints(const std::string &file);
-    void updateBezierTrajectory();
+    // Follows the spline path in file (Bezier or Catmull-Rom) once it has
+    // loaded; the motion itself is computed by trajectoryBatch.
+    void setTrajectoryFile(const std::string &file);
+    void clearBezierTrajectory();
+    // Speed along the trajectory in world units per second.
+    void setTrajectorySpeed(float unitsPerSecond);
+    float getTrajectorySpeed() const { return trajectorySpeed; }
+    // For an entity still waiting on its trajectory: if the load failed,
+    // reports it and stops following.
+    bool trajectoryFailed();
 
 private:
-    glm::vec3 position;
-    glm::vec3 rotation;
+    EntityHandle handle;
 
     glm::vec3 baseColor;
-    glm::vec3 initialRotation;
-    float scaleFactor;
-
-    bool rotateX, rotateY, rotateZ;
-
-    GLuint VAO;
-    GLuint textureID;
-    int nVertices;
-    GLuint shaderProgram;
 
     std::string objFilePath;
     std::string mtlFilePath;
     std::string textureFilePath;
+    std::string trajectoryFilePath;
+    std::string sceneKey;
 
-    float ka, kd, ks, shininess;
-
-    std::vector<glm::vec3> bezierControlPoints;
-    std::vector<glm::vec3> bezierRotations;
+    TrajectoryHandle trajectory;
 
-    float bezierT = 0.0f;
-    float bezierSpeed = 0.001f;
+    float trajectorySpeed = 1.0f;
 
-    int loadModelWithTexture(const std::string &objFilePath,
-                             const std::string &mtlFilePath,
-                             const std::string &textureFilePath,
-                             int &outVertices,
-                             GLuint &outTextureID);
+    const MeshRecord &mesh() const { return assetManager.mesh(entityStore.mesh[row()]); }
+    const MaterialRecord &material() const { return entityStore.material[row()]; }
+    void toggleFlag(uint8_t flag);
 
-    void loadMaterial(const std::string &mtlFilePath);
-    GLuint loadTexture(const std::string &texturePath);
+    bool bindObjectUniforms(StreamRingBuffer &uniformRing);
 
-    void setupShaders();
-    void checkCompileErrors(GLuint shader, std::string type);
+    static GLuint setupShaders();
+    static void checkCompileErrors(GLuint shader, std::string type);
 
     static constexpr float TRANSLATION_SPEED = 0.1f;
 };
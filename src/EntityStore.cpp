@@ -0,0 +1,258 @@
+#include "EntityStore.h"
+#include "WorkerPool.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <iostream>
+
+EntityStore entityStore;
+
+EntityHandle EntityStore::create(const glm::vec3 &initialPosition, const glm::vec3 &initialRotation, float initialScale)
+{
+    EntityHandle handle;
+    if (!freeSlots.empty())
+    {
+        handle.slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        handle.slot = static_cast<uint32_t>(slotRow.size());
+        slotRow.push_back(0);
+        slotGeneration.push_back(0);
+    }
+    handle.generation = slotGeneration[handle.slot];
+
+    uint32_t r = static_cast<uint32_t>(position.size());
+    slotRow[handle.slot] = r;
+    rowSlot.push_back(handle.slot);
+
+    position.push_back(initialPosition);
+    rotation.push_back(initialRotation);
+    baseRotation.push_back(initialRotation);
+    previousPosition.push_back(initialPosition);
+    previousRotation.push_back(initialRotation);
+    scale.push_back(initialScale);
+    flags.push_back(ENTITY_TRANSFORM_DIRTY);
+    mesh.emplace_back();
+    material.emplace_back();
+    parent.push_back(NO_PARENT);
+    localMatrix.push_back(glm::mat4(1.0f));
+    model.push_back(glm::mat4(1.0f));
+    localChanged.push_back(0);
+    worldChanged.push_back(0);
+    hierarchyDirty = true;
+    uniformFrame.push_back(~0ull);
+    uniformOffset.push_back(0);
+    return handle;
+}
+
+template <typename T>
+static void swapRemove(std::vector<T> &column, uint32_t r)
+{
+    column[r] = column.back();
+    column.pop_back();
+}
+
+void EntityStore::destroy(EntityHandle handle)
+{
+    if (!isValid(handle))
+        return;
+
+    uint32_t r = slotRow[handle.slot];
+    uint32_t last = static_cast<uint32_t>(position.size()) - 1;
+    if (parent[r] != NO_PARENT)
+        --parentedRows;
+
+    swapRemove(position, r);
+    swapRemove(rotation, r);
+    swapRemove(baseRotation, r);
+    swapRemove(previousPosition, r);
+    swapRemove(previousRotation, r);
+    swapRemove(scale, r);
+    swapRemove(flags, r);
+    swapRemove(mesh, r);
+    swapRemove(material, r);
+    swapRemove(parent, r);
+    swapRemove(localMatrix, r);
+    swapRemove(model, r);
+    swapRemove(localChanged, r);
+    swapRemove(worldChanged, r);
+    swapRemove(uniformFrame, r);
+    swapRemove(uniformOffset, r);
+    swapRemove(rowSlot, r);
+
+    if (r != last)
+        slotRow[rowSlot[r]] = r;
+
+    // Orphaned children become roots; references to the moved row follow it.
+    // Flat scenes (e.g. streamed cells) have no parents and skip the O(N) scan.
+    for (uint32_t i = 0; parentedRows > 0 && i < parent.size(); ++i)
+    {
+        if (parent[i] == r)
+        {
+            parent[i] = NO_PARENT;
+            --parentedRows;
+            markDirty(i);
+        }
+        else if (parent[i] == last)
+            parent[i] = r;
+    }
+    hierarchyDirty = true;
+    slotGeneration[handle.slot]++;
+    freeSlots.push_back(handle.slot);
+}
+
+bool EntityStore::isValid(EntityHandle handle) const
+{
+    return handle.slot < slotGeneration.size() && slotGeneration[handle.slot] == handle.generation;
+}
+
+bool EntityStore::setParent(uint32_t child, uint32_t parentRow)
+{
+    for (uint32_t r = parentRow; r != NO_PARENT; r = parent[r])
+    {
+        if (r == child)
+        {
+            std::cerr << "Refusing to parent row " << child << " to its own descendant " << parentRow << std::endl;
+            return false;
+        }
+    }
+    if (parent[child] == NO_PARENT && parentRow != NO_PARENT)
+        ++parentedRows;
+    else if (parent[child] != NO_PARENT && parentRow == NO_PARENT)
+        --parentedRows;
+    parent[child] = parentRow;
+    markDirty(child);
+    hierarchyDirty = true;
+    return true;
+}
+
+void EntityStore::rebuildHierarchyOrder()
+{
+    const uint32_t count = static_cast<uint32_t>(position.size());
+
+    // Depth of every row, memoized so each chain is walked once.
+    std::vector<uint32_t> depth(count, NO_PARENT);
+    uint32_t maxDepth = 0;
+    std::vector<uint32_t> chain;
+    for (uint32_t r = 0; r < count; ++r)
+    {
+        uint32_t cursor = r;
+        while (cursor != NO_PARENT && depth[cursor] == NO_PARENT)
+        {
+            chain.push_back(cursor);
+            cursor = parent[cursor];
+        }
+        uint32_t d = cursor == NO_PARENT ? 0 : depth[cursor] + 1;
+        while (!chain.empty())
+        {
+            depth[chain.back()] = d++;
+            chain.pop_back();
+        }
+        maxDepth = std::max(maxDepth, depth[r]);
+    }
+
+    // Counting sort by depth: parents always come before their children.
+    levelStart.assign(count ? maxDepth + 2 : 1, 0);
+    for (uint32_t r = 0; r < count; ++r)
+        levelStart[depth[r] + 1]++;
+    for (size_t d = 1; d < levelStart.size(); ++d)
+        levelStart[d] += levelStart[d - 1];
+    hierarchyOrder.resize(count);
+    std::vector<uint32_t> cursor(levelStart.begin(), levelStart.end() - 1);
+    for (uint32_t r = 0; r < count; ++r)
+        hierarchyOrder[cursor[depth[r]]++] = r;
+
+    hierarchyDirty = false;
+}
+
+void EntityStore::propagateLevel(uint32_t begin, uint32_t end)
+{
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        uint32_t r = hierarchyOrder[i];
+        uint32_t p = parent[r];
+
+        bool moving = (flags[r] & ENTITY_ANIMATED) || (p != NO_PARENT && (flags[p] & ENTITY_MOVING));
+        flags[r] = static_cast<uint8_t>(moving ? (flags[r] | ENTITY_MOVING) : (flags[r] & ~ENTITY_MOVING));
+
+        worldChanged[r] = 0;
+        bool parentChanged = p != NO_PARENT && worldChanged[p];
+        if (!localChanged[r] && !parentChanged)
+            continue;
+
+        glm::mat4 world = p == NO_PARENT ? localMatrix[r] : model[p] * localMatrix[r];
+        if (world != model[r])
+        {
+            model[r] = world;
+            worldChanged[r] = 1;
+        }
+    }
+}
+
+void EntityStore::updateTransforms(float time, float alpha, std::vector<uint32_t> &changedRows)
+{
+    if (hierarchyDirty)
+        rebuildHierarchyOrder();
+
+    // Local pass: only rows that animate or were edited.
+    const uint32_t count = static_cast<uint32_t>(position.size());
+    for (uint32_t r = 0; r < count; ++r)
+    {
+        uint8_t f = flags[r];
+        localChanged[r] = 0;
+        if (!(f & (ENTITY_ANIMATED | ENTITY_TRANSFORM_DIRTY)))
+            continue;
+        flags[r] = static_cast<uint8_t>(f & ~ENTITY_TRANSFORM_DIRTY);
+
+        glm::vec3 translation = position[r];
+        glm::vec3 angles = baseRotation[r];
+        if (f & ENTITY_FOLLOW_BEZIER)
+        {
+            translation = glm::mix(previousPosition[r], position[r], alpha);
+            angles = glm::mix(previousRotation[r], rotation[r], alpha);
+        }
+        glm::mat4 m = glm::translate(glm::mat4(1.0f), translation);
+        m = glm::scale(m, glm::vec3(scale[r]));
+        m = glm::rotate(m, angles.x, glm::vec3(1.0f, 0.0f, 0.0f));
+        m = glm::rotate(m, angles.y, glm::vec3(0.0f, 1.0f, 0.0f));
+        m = glm::rotate(m, angles.z, glm::vec3(0.0f, 0.0f, 1.0f));
+
+        if (f & ENTITY_ROTATE_X)
+            m = glm::rotate(m, time, glm::vec3(1.0f, 0.0f, 0.0f));
+        if (f & ENTITY_ROTATE_Y)
+            m = glm::rotate(m, time, glm::vec3(0.0f, 1.0f, 0.0f));
+        if (f & ENTITY_ROTATE_Z)
+            m = glm::rotate(m, time, glm::vec3(0.0f, 0.0f, 1.0f));
+
+        if (m != localMatrix[r])
+        {
+            localMatrix[r] = m;
+            localChanged[r] = 1;
+        }
+    }
+
+    // World pass, one level at a time. Rows of a level only read the level
+    // above, so wide levels are split across threads.
+    const unsigned int hardwareThreads = workerPool.concurrency();
+    for (size_t level = 0; level + 1 < levelStart.size(); ++level)
+    {
+        uint32_t begin = levelStart[level], end = levelStart[level + 1];
+        unsigned int workers = std::min<unsigned int>(hardwareThreads, (end - begin) / PARALLEL_LEVEL_ROWS);
+        if (workers <= 1)
+        {
+            propagateLevel(begin, end);
+            continue;
+        }
+
+        uint32_t chunk = (end - begin + workers - 1) / workers;
+        workerPool.parallelFor(workers, [this, begin, end, chunk](unsigned int w)
+                               {
+            uint32_t chunkBegin = std::min(end, begin + w * chunk);
+            propagateLevel(chunkBegin, std::min(end, chunkBegin + chunk)); });
+    }
+
+    for (uint32_t r = 0; r < count; ++r)
+        if (worldChanged[r])
+            changedRows.push_back(r);
+}
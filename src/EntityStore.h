@@ -0,0 +1,119 @@
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "AssetManager.h"
+#include "Bounds.h"
+
+// Stable reference to an entity row. The slot is reused after destroy() with
+// a bumped generation, so stale handles are detected instead of aliasing.
+struct EntityHandle
+{
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+
+    uint32_t slot = INVALID;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle &other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const EntityHandle &other) const { return !(*this == other); }
+};
+
+// Per-row material: the coefficients come from the entity's own .mtl, the
+// texture and program are shared through assetManager.
+struct MaterialRecord
+{
+    glm::vec4 coefficients = glm::vec4(0.1f, 0.5f, 0.5f, 10.0f); // ka, kd, ks, shininess
+    TextureHandle texture;
+    ProgramHandle program;
+};
+
+enum EntityFlag : uint8_t
+{
+    ENTITY_ROTATE_X = 1 << 0,
+    ENTITY_ROTATE_Y = 1 << 1,
+    ENTITY_ROTATE_Z = 1 << 2,
+    ENTITY_FOLLOW_BEZIER = 1 << 3,
+    ENTITY_TRANSFORM_DIRTY = 1 << 4,
+    // Animated itself or through an ancestor; refreshed by updateTransforms().
+    ENTITY_MOVING = 1 << 5,
+
+    ENTITY_ANIMATED = ENTITY_ROTATE_X | ENTITY_ROTATE_Y | ENTITY_ROTATE_Z | ENTITY_FOLLOW_BEZIER,
+};
+
+// Data-oriented storage of the per-frame entity state: one contiguous column
+// per attribute, densely packed so loops only stream the columns they use.
+// Rows may have a parent row; world matrices are cached and only recomputed
+// when the local transform or an ancestor's world matrix changed, level by
+// level over a flat breadth-first order.
+// Rows are created in the same order the scene appends to its entity list,
+// so a row index doubles as the index into that list; destroy() swap-removes
+// and the caller must mirror the swap in any parallel array.
+class EntityStore
+{
+public:
+    static constexpr uint32_t NO_PARENT = 0xFFFFFFFFu;
+    // Levels narrower than this are propagated on the calling thread.
+    static constexpr uint32_t PARALLEL_LEVEL_ROWS = 4096;
+
+    EntityHandle create(const glm::vec3 &position, const glm::vec3 &rotation, float scale);
+    void destroy(EntityHandle handle);
+    bool isValid(EntityHandle handle) const;
+    uint32_t row(EntityHandle handle) const { return slotRow[handle.slot]; }
+    // For tables keyed by EntityHandle::slot.
+    uint32_t rowOfSlot(uint32_t slot) const { return slotRow[slot]; }
+    size_t size() const { return position.size(); }
+
+    void markDirty(uint32_t r) { flags[r] |= ENTITY_TRANSFORM_DIRTY; }
+
+    // Attaches a row below another (or detaches with NO_PARENT); refuses cycles.
+    bool setParent(uint32_t child, uint32_t parentRow);
+
+    // Recomputes the local matrix of animated or dirty rows, propagates world
+    // matrices down the hierarchy and appends the rows whose world matrix changed.
+    // time drives the spinning rows; trajectory rows are placed alpha of the
+    // way from their previous to their current simulated state.
+    void updateTransforms(float time, float alpha, std::vector<uint32_t> &changedRows);
+    size_t hierarchyDepth() const { return levelStart.empty() ? 0 : levelStart.size() - 1; }
+
+    // Hot columns, indexed by row.
+    std::vector<glm::vec3> position;
+    std::vector<glm::vec3> rotation;     // trajectory-driven orientation (radians)
+    std::vector<glm::vec3> baseRotation; // authored orientation (radians)
+    // Trajectory state at the tick before the current one.
+    std::vector<glm::vec3> previousPosition;
+    std::vector<glm::vec3> previousRotation;
+    std::vector<float> scale;
+    std::vector<uint8_t> flags;
+    std::vector<MeshHandle> mesh;
+    std::vector<MaterialRecord> material;
+    std::vector<uint32_t> parent; // written through setParent() only
+    std::vector<glm::mat4> localMatrix;
+    std::vector<glm::mat4> model; // world matrix
+    std::vector<unsigned long long> uniformFrame; // ring frame of the cached ObjectData
+    std::vector<GLintptr> uniformOffset;
+
+private:
+    // Rows with a parent; while zero, destroy() skips the scan for children.
+    size_t parentedRows = 0;
+    std::vector<uint32_t> slotRow;
+    std::vector<uint32_t> slotGeneration;
+    std::vector<uint32_t> rowSlot;
+    std::vector<uint32_t> freeSlots;
+
+    // Rows sorted by depth; level d spans [levelStart[d], levelStart[d + 1]).
+    std::vector<uint32_t> hierarchyOrder;
+    std::vector<uint32_t> levelStart;
+    bool hierarchyDirty = true;
+    std::vector<uint8_t> localChanged;
+    std::vector<uint8_t> worldChanged;
+
+    void rebuildHierarchyOrder();
+    void propagateLevel(uint32_t begin, uint32_t end);
+};
+
+extern EntityStore entityStore;
+
+#endif
@@ -0,0 +1,89 @@
+#include "FileWatcher.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+bool FileWatcher::watch(const std::string &path)
+{
+    stop();
+    size_t slash = path.find_last_of("/\\");
+    directory = slash == std::string::npos ? "." : path.substr(0, slash);
+    fileName = slash == std::string::npos ? path : path.substr(slash + 1);
+
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "inotify_init1 failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    watchDescriptor = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watchDescriptor < 0)
+    {
+        std::cerr << "Failed to watch " << directory << ": " << std::strerror(errno) << std::endl;
+        stop();
+        return false;
+    }
+#else
+    std::error_code error;
+    lastWrite = std::filesystem::last_write_time(path, error);
+    watching = !error;
+    if (error)
+    {
+        std::cerr << "Failed to watch " << path << ": " << error.message() << std::endl;
+        return false;
+    }
+#endif
+    return true;
+}
+
+void FileWatcher::stop()
+{
+#ifdef __linux__
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    watchDescriptor = -1;
+#else
+    watching = false;
+#endif
+}
+
+bool FileWatcher::poll()
+{
+#ifdef __linux__
+    if (fd < 0)
+        return false;
+
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    for (;;)
+    {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        for (char *cursor = buffer; cursor < buffer + length;)
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event *>(cursor);
+            if (event->len > 0 && fileName == event->name)
+                changed = true;
+            cursor += sizeof(inotify_event) + event->len;
+        }
+    }
+    return changed;
+#else
+    if (!watching)
+        return false;
+    std::error_code error;
+    auto writeTime = std::filesystem::last_write_time(directory + "/" + fileName, error);
+    if (error || writeTime == lastWrite)
+        return false;
+    lastWrite = writeTime;
+    return true;
+#endif
+}
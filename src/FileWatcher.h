@@ -0,0 +1,35 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <string>
+#ifndef __linux__
+#include <filesystem>
+#endif
+
+// Reports modifications of a single file. On Linux this is an inotify watch
+// on the parent directory, so editors that save by writing a temporary file
+// and renaming it over the original are caught too; elsewhere it falls back
+// to comparing the modification time.
+class FileWatcher
+{
+public:
+    ~FileWatcher() { stop(); }
+
+    bool watch(const std::string &path);
+    void stop();
+
+    // Non-blocking; true once for any number of writes since the last call.
+    bool poll();
+
+private:
+    std::string directory, fileName;
+#ifdef __linux__
+    int fd = -1;
+    int watchDescriptor = -1;
+#else
+    std::filesystem::file_time_type lastWrite;
+    bool watching = false;
+#endif
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "FrustumCuller.h"
+#include "CpuFeatures.h"
+
+void FrustumCuller::resize(size_t newCount)
+{
+    count = newCount;
+    size_t padded = (newCount + 7) & ~size_t(7);
+    centerX.resize(padded, 0.0f);
+    centerY.resize(padded, 0.0f);
+    centerZ.resize(padded, 0.0f);
+    radius.resize(padded, -1.0f);
+
+    for (size_t i = newCount; i < padded; ++i)
+        radius[i] = -1.0f;
+}
+
+void FrustumCuller::setSphere(size_t index, const BoundingSphere &sphere)
+{
+    centerX[index] = sphere.center.x;
+    centerY[index] = sphere.center.y;
+    centerZ[index] = sphere.center.z;
+    radius[index] = sphere.radius;
+}
+
+bool FrustumCuller::hasSIMD()
+{
+    return cpuHasAVX2();
+}
+
+void FrustumCuller::cullScalar(const Frustum &frustum, std::vector<uint32_t> &visible) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec3 c(centerX[i], centerY[i], centerZ[i]);
+        if (radius[i] >= 0.0f && frustum.intersectsSphere(c, radius[i]))
+            visible.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+#if defined(CG_AVX2_KERNELS)
+CG_AVX2_TARGET static void cullAVX2(const Frustum &frustum, size_t count, const float *centerX, const float *centerY,
+                                    const float *centerZ, const float *radius, std::vector<uint32_t> &visible)
+{
+    __m256 px[Frustum::COUNT], py[Frustum::COUNT], pz[Frustum::COUNT], pw[Frustum::COUNT];
+    for (int p = 0; p < Frustum::COUNT; ++p)
+    {
+        px[p] = _mm256_set1_ps(frustum.planes[p].x);
+        py[p] = _mm256_set1_ps(frustum.planes[p].y);
+        pz[p] = _mm256_set1_ps(frustum.planes[p].z);
+        pw[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(centerX + i);
+        __m256 y = _mm256_loadu_ps(centerY + i);
+        __m256 z = _mm256_loadu_ps(centerZ + i);
+        __m256 r = _mm256_loadu_ps(radius + i);
+        __m256 negR = _mm256_sub_ps(zero, r);
+
+        // Padding spheres have a negative radius and must never pass.
+        __m256 inside = _mm256_cmp_ps(r, zero, _CMP_GE_OQ);
+        for (int p = 0; p < Frustum::COUNT; ++p)
+        {
+            __m256 d = _mm256_fmadd_ps(px[p], x, pw[p]);
+            d = _mm256_fmadd_ps(py[p], y, d);
+            d = _mm256_fmadd_ps(pz[p], z, d);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(inside));
+        while (mask)
+        {
+            visible.push_back(static_cast<uint32_t>(i + lowestBit(mask)));
+            mask &= mask - 1;
+        }
+    }
+}
+#endif
+
+void FrustumCuller::cull(const Frustum &frustum, std::vector<uint32_t> &visible) const
+{
+#if defined(CG_AVX2_KERNELS)
+    if (hasSIMD())
+    {
+        cullAVX2(frustum, count, centerX.data(), centerY.data(), centerZ.data(), radius.data(), visible);
+        return;
+    }
+#endif
+    cullScalar(frustum, visible);
+}
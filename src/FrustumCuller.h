@@ -0,0 +1,30 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+// Bounding spheres kept as structure-of-arrays so the AVX2 path can test
+// 8 objects per iteration. Arrays are padded to a multiple of 8 with
+// spheres that are always culled.
+class FrustumCuller
+{
+public:
+    void resize(size_t count);
+    void setSphere(size_t index, const BoundingSphere &sphere);
+    size_t size() const { return count; }
+
+    // Appends the indices of the spheres that touch the frustum.
+    void cull(const Frustum &frustum, std::vector<uint32_t> &visible) const;
+    void cullScalar(const Frustum &frustum, std::vector<uint32_t> &visible) const;
+
+    // cull() uses AVX2 when compiled in (CG_ENABLE_AVX2) and the CPU has it.
+    static bool hasSIMD();
+
+private:
+    size_t count = 0;
+    std::vector<float> centerX, centerY, centerZ, radius;
+};
+
+#endif
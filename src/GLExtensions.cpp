@@ -0,0 +1,43 @@
+#include "GLExtensions.h"
+#include <iostream>
+#include <GLFW/glfw3.h>
+
+GLExtensions glExt;
+
+static bool hasFeature(int coreVersion, const char *extension)
+{
+    return glExt.version >= coreVersion || glfwExtensionSupported(extension);
+}
+
+void loadGLExtensions()
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    glExt.version = major * 10 + minor;
+
+    if (hasFeature(44, "GL_ARB_buffer_storage"))
+    {
+        glExt.BufferStorage = (PFNGLBUFFERSTORAGEEXTPROC)glfwGetProcAddress("glBufferStorage");
+        glExt.bufferStorage = glExt.BufferStorage != nullptr;
+    }
+
+    glExt.conservativeOcclusion = hasFeature(43, "GL_ARB_ES3_compatibility");
+    glExt.pipelineStatistics = hasFeature(46, "GL_ARB_pipeline_statistics_query");
+
+    if (glExt.version >= 43)
+    {
+        glExt.DispatchCompute = (PFNGLDISPATCHCOMPUTEEXTPROC)glfwGetProcAddress("glDispatchCompute");
+        glExt.MemoryBarrier = (PFNGLMEMORYBARRIEREXTPROC)glfwGetProcAddress("glMemoryBarrier");
+        glExt.MultiDrawArraysIndirect = (PFNGLMULTIDRAWARRAYSINDIRECTEXTPROC)glfwGetProcAddress("glMultiDrawArraysIndirect");
+        glExt.BindImageTexture = (PFNGLBINDIMAGETEXTUREEXTPROC)glfwGetProcAddress("glBindImageTexture");
+        glExt.gpuDriven = glExt.DispatchCompute && glExt.MemoryBarrier &&
+                          glExt.MultiDrawArraysIndirect && glExt.BindImageTexture;
+    }
+
+    std::cout << "OpenGL " << major << "." << minor
+              << " | buffer storage: " << (glExt.bufferStorage ? "yes" : "no")
+              << " | conservative occlusion: " << (glExt.conservativeOcclusion ? "yes" : "no")
+              << " | pipeline statistics: " << (glExt.pipelineStatistics ? "yes" : "no")
+              << " | compute/indirect: " << (glExt.gpuDriven ? "yes" : "no") << std::endl;
+}
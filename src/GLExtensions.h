@@ -0,0 +1,78 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+// glad was generated for GL 4.0, so anything newer is resolved here at runtime
+// and only used when the driver reports it.
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DISPATCH_INDIRECT_BUFFER
+#define GL_DISPATCH_INDIRECT_BUFFER 0x90EE
+#endif
+#ifndef GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+#define GL_ANY_SAMPLES_PASSED_CONSERVATIVE 0x8D6A
+#endif
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS
+#define GL_FRAGMENT_SHADER_INVOCATIONS 0x82F4
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#endif
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+
+typedef void(APIENTRYP PFNGLBUFFERSTORAGEEXTPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void(APIENTRYP PFNGLDISPATCHCOMPUTEEXTPROC)(GLuint x, GLuint y, GLuint z);
+typedef void(APIENTRYP PFNGLMEMORYBARRIEREXTPROC)(GLbitfield barriers);
+typedef void(APIENTRYP PFNGLMULTIDRAWARRAYSINDIRECTEXTPROC)(GLenum mode, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void(APIENTRYP PFNGLBINDIMAGETEXTUREEXTPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+
+struct GLExtensions
+{
+    int version = 0; // major * 10 + minor
+
+    bool bufferStorage = false;
+    PFNGLBUFFERSTORAGEEXTPROC BufferStorage = nullptr;
+
+    bool conservativeOcclusion = false; // GL_ANY_SAMPLES_PASSED_CONSERVATIVE
+    bool pipelineStatistics = false;    // GL_FRAGMENT_SHADER_INVOCATIONS queries
+
+    // GL 4.3 compute + SSBO + multi-draw-indirect, used by the GPU-driven path.
+    bool gpuDriven = false;
+    PFNGLDISPATCHCOMPUTEEXTPROC DispatchCompute = nullptr;
+    PFNGLMEMORYBARRIEREXTPROC MemoryBarrier = nullptr;
+    PFNGLMULTIDRAWARRAYSINDIRECTEXTPROC MultiDrawArraysIndirect = nullptr;
+    PFNGLBINDIMAGETEXTUREEXTPROC BindImageTexture = nullptr;
+};
+
+extern GLExtensions glExt;
+
+// Must be called after gladLoadGLLoader, with the context current.
+void loadGLExtensions();
+
+#endif
@@ -0,0 +1,261 @@
+#include "GLState.h"
+#include "GLExtensions.h"
+#include <iostream>
+
+GLStateCache glState;
+
+static void count(GLCallStats &stats, bool redundant)
+{
+    if (redundant)
+        stats.skipped++;
+    else
+        stats.issued++;
+}
+
+GLCallStats GLStateStats::total() const
+{
+    GLCallStats sum;
+    for (const GLCallStats *s : {&useProgram, &bindVertexArray, &activeTexture, &bindTexture, &bindBuffer, &bindBufferRange})
+    {
+        sum.issued += s->issued;
+        sum.skipped += s->skipped;
+    }
+    return sum;
+}
+
+GLStateCache::GLStateCache()
+{
+    invalidate();
+}
+
+int GLStateCache::textureSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_2D_ARRAY:
+        return 1;
+    case GL_TEXTURE_CUBE_MAP:
+        return 2;
+    case GL_TEXTURE_3D:
+        return 3;
+    case GL_TEXTURE_BUFFER:
+        return 4;
+    default:
+        return -1;
+    }
+}
+
+int GLStateCache::bufferSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return 0;
+    case GL_UNIFORM_BUFFER:
+        return 1;
+    case GL_SHADER_STORAGE_BUFFER:
+        return 2;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return 3;
+    case GL_DISPATCH_INDIRECT_BUFFER:
+        return 4;
+    case GL_TEXTURE_BUFFER:
+        return 5;
+    default:
+        return -1; // e.g. GL_ELEMENT_ARRAY_BUFFER, which belongs to the VAO
+    }
+}
+
+void GLStateCache::useProgram(GLuint id)
+{
+    bool redundant = program == id;
+    count(current.useProgram, redundant);
+    if (redundant)
+        return;
+    program = id;
+    glUseProgram(id);
+}
+
+void GLStateCache::bindVertexArray(GLuint vao)
+{
+    bool redundant = vertexArray == vao;
+    count(current.bindVertexArray, redundant);
+    if (redundant)
+        return;
+    vertexArray = vao;
+    glBindVertexArray(vao);
+}
+
+void GLStateCache::activeTexture(GLenum unit)
+{
+    GLuint index = unit - GL_TEXTURE0;
+    bool redundant = activeUnit == index;
+    count(current.activeTexture, redundant);
+    if (redundant)
+        return;
+    activeUnit = index;
+    glActiveTexture(unit);
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+    int slot = textureSlot(target);
+    bool tracked = slot >= 0 && activeUnit < MAX_TEXTURE_UNITS;
+    bool redundant = tracked && textures[activeUnit][slot] == texture;
+    count(current.bindTexture, redundant);
+    if (redundant)
+        return;
+    if (tracked)
+        textures[activeUnit][slot] = texture;
+    glBindTexture(target, texture);
+}
+
+void GLStateCache::bindTextureUnit(GLuint unit, GLenum target, GLuint texture)
+{
+    int slot = textureSlot(target);
+    if (slot >= 0 && unit < MAX_TEXTURE_UNITS && textures[unit][slot] == texture)
+    {
+        count(current.bindTexture, true);
+        return;
+    }
+    activeTexture(GL_TEXTURE0 + unit);
+    bindTexture(target, texture);
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    int slot = bufferSlot(target);
+    bool redundant = slot >= 0 && buffers[slot] == buffer;
+    count(current.bindBuffer, redundant);
+    if (redundant)
+        return;
+    if (slot >= 0)
+        buffers[slot] = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    int slot = bufferSlot(target);
+    bool tracked = slot >= 0 && index < MAX_BUFFER_INDICES;
+    if (tracked)
+    {
+        const IndexedBinding &b = indexedBuffers[slot][index];
+        bool redundant = b.buffer == buffer && b.offset == offset && b.size == size;
+        count(current.bindBufferRange, redundant);
+        if (redundant)
+            return;
+        indexedBuffers[slot][index] = {buffer, offset, size};
+    }
+    else
+    {
+        count(current.bindBufferRange, false);
+    }
+
+    // Binding an indexed target also replaces the generic binding.
+    if (slot >= 0)
+        buffers[slot] = buffer;
+    glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    // Whole-buffer bindings are shadowed as offset 0 / size -1.
+    int slot = bufferSlot(target);
+    bool tracked = slot >= 0 && index < MAX_BUFFER_INDICES;
+    if (tracked)
+    {
+        const IndexedBinding &b = indexedBuffers[slot][index];
+        bool redundant = b.buffer == buffer && b.offset == 0 && b.size == -1;
+        count(current.bindBufferRange, redundant);
+        if (redundant)
+            return;
+        indexedBuffers[slot][index] = {buffer, 0, -1};
+    }
+    else
+    {
+        count(current.bindBufferRange, false);
+    }
+
+    if (slot >= 0)
+        buffers[slot] = buffer;
+    glBindBufferBase(target, index, buffer);
+}
+
+void GLStateCache::deleteProgram(GLuint id)
+{
+    if (program == id)
+        program = 0;
+    glDeleteProgram(id);
+}
+
+void GLStateCache::deleteVertexArray(GLuint vao)
+{
+    if (vertexArray == vao)
+        vertexArray = 0;
+    glDeleteVertexArrays(1, &vao);
+}
+
+void GLStateCache::deleteTexture(GLuint texture)
+{
+    for (auto &unit : textures)
+        for (GLuint &bound : unit)
+            if (bound == texture)
+                bound = 0;
+    glDeleteTextures(1, &texture);
+}
+
+void GLStateCache::deleteBuffer(GLuint buffer)
+{
+    for (int slot = 0; slot < BUFFER_TARGETS; ++slot)
+    {
+        if (buffers[slot] == buffer)
+            buffers[slot] = 0;
+        for (IndexedBinding &b : indexedBuffers[slot])
+            if (b.buffer == buffer)
+                b = {0, 0, 0};
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLStateCache::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (auto &unit : textures)
+        for (GLuint &bound : unit)
+            bound = UNKNOWN;
+    for (int slot = 0; slot < BUFFER_TARGETS; ++slot)
+    {
+        buffers[slot] = UNKNOWN;
+        for (IndexedBinding &b : indexedBuffers[slot])
+            b = {UNKNOWN, -1, -1};
+    }
+}
+
+void GLStateCache::beginFrame()
+{
+    lastFrame = current;
+    current = GLStateStats();
+}
+
+void GLStateCache::printStats() const
+{
+    auto line = [](const char *name, const GLCallStats &s)
+    {
+        std::cout << "  " << name << ": " << s.issued << " issued, " << s.skipped << " skipped" << std::endl;
+    };
+
+    std::cout << "GL state (last frame):" << std::endl;
+    line("glUseProgram      ", lastFrame.useProgram);
+    line("glBindVertexArray ", lastFrame.bindVertexArray);
+    line("glActiveTexture   ", lastFrame.activeTexture);
+    line("glBindTexture     ", lastFrame.bindTexture);
+    line("glBindBuffer      ", lastFrame.bindBuffer);
+    line("glBindBufferRange ", lastFrame.bindBufferRange);
+    line("total             ", lastFrame.total());
+    std::cout << "  draw calls         : " << lastFrame.drawCalls << std::endl;
+}
@@ -0,0 +1,89 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+struct GLCallStats
+{
+    unsigned int issued = 0;
+    unsigned int skipped = 0;
+};
+
+struct GLStateStats
+{
+    GLCallStats useProgram;
+    GLCallStats bindVertexArray;
+    GLCallStats activeTexture;
+    GLCallStats bindTexture;
+    GLCallStats bindBuffer;
+    GLCallStats bindBufferRange;
+    unsigned int drawCalls = 0; // glDraw* and multi-draw submissions
+
+    GLCallStats total() const;
+};
+
+// Shadows the current GL bindings so redundant binds never reach the driver.
+// Every bind in the renderer goes through glState; code that touches the
+// bindings directly must call invalidate() afterwards.
+class GLStateCache
+{
+public:
+    GLStateCache();
+
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void activeTexture(GLenum unit);
+    void bindTexture(GLenum target, GLuint texture);
+    void bindTextureUnit(GLuint unit, GLenum target, GLuint texture);
+    void bindBuffer(GLenum target, GLuint buffer);
+    void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+    // Deleting a bound object resets that binding to 0 in GL, so the shadow must follow.
+    void deleteProgram(GLuint program);
+    void deleteVertexArray(GLuint vao);
+    void deleteTexture(GLuint texture);
+    void deleteBuffer(GLuint buffer);
+
+    void invalidate();
+
+    // Not a binding, but counted here so draws show up next to the bind statistics.
+    void countDrawCall() { current.drawCalls++; }
+
+    void beginFrame();
+    const GLStateStats &lastFrameStats() const { return lastFrame; }
+    const GLStateStats &currentStats() const { return current; }
+
+    void printStats() const;
+
+private:
+    static constexpr int MAX_TEXTURE_UNITS = 32;
+    static constexpr int TEXTURE_TARGETS = 5;
+    static constexpr int BUFFER_TARGETS = 6;
+    static constexpr int MAX_BUFFER_INDICES = 16;
+    static constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+
+    struct IndexedBinding
+    {
+        GLuint buffer;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    GLuint program;
+    GLuint vertexArray;
+    GLuint activeUnit;
+    GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+    GLuint buffers[BUFFER_TARGETS];
+    IndexedBinding indexedBuffers[BUFFER_TARGETS][MAX_BUFFER_INDICES];
+
+    GLStateStats current;
+    GLStateStats lastFrame;
+
+    static int textureSlot(GLenum target);
+    static int bufferSlot(GLenum target);
+};
+
+extern GLStateCache glState;
+
+#endif
@@ -0,0 +1,597 @@
+#include "GpuDrivenRenderer.h"
+#include "ClusteredLighting.h"
+#include "ShadowMapper.h"
+#include "Entity.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <glm/gtc/type_ptr.hpp>
+
+static const GLchar *cullSource = R"glsl(
+    #version 430 core
+    layout(local_size_x = 64) in;
+
+    struct Instance { mat4 model; vec4 sphere; vec4 material; uvec4 batch; };
+    struct DrawCommand { uint count; uint instanceCount; uint first; uint baseInstance; };
+    const uint NO_BATCH = 0xFFFFFFFFu;
+
+    layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+    layout(std430, binding = 1) buffer Commands { DrawCommand commands[]; };
+    layout(std430, binding = 2) writeonly buffer Visible { uint visibleIndices[]; };
+
+    uniform uint instanceCount;
+    uniform vec4 frustumPlanes[6];
+    uniform bool useHiZ;
+    uniform mat4 previousViewProjection;
+    uniform sampler2D hiZ;
+    uniform vec2 hiZSize;
+    uniform int hiZLevels;
+
+    // Tests the sphere's box against last frame's depth pyramid.
+    bool occludedByHiZ(vec3 center, float radius) {
+        vec2 minUV = vec2(1.0);
+        vec2 maxUV = vec2(0.0);
+        float nearestDepth = 1.0;
+        for (int i = 0; i < 8; ++i) {
+            vec3 corner = center + radius * vec3((i & 1) != 0 ? 1.0 : -1.0,
+                                                 (i & 2) != 0 ? 1.0 : -1.0,
+                                                 (i & 4) != 0 ? 1.0 : -1.0);
+            vec4 clip = previousViewProjection * vec4(corner, 1.0);
+            if (clip.w <= 0.0)
+                return false;
+            vec3 ndc = clip.xyz / clip.w;
+            minUV = min(minUV, ndc.xy * 0.5 + 0.5);
+            maxUV = max(maxUV, ndc.xy * 0.5 + 0.5);
+            nearestDepth = min(nearestDepth, ndc.z * 0.5 + 0.5);
+        }
+        minUV = clamp(minUV, 0.0, 1.0);
+        maxUV = clamp(maxUV, 0.0, 1.0);
+
+        vec2 sizeInPixels = (maxUV - minUV) * hiZSize;
+        float level = clamp(ceil(log2(max(max(sizeInPixels.x, sizeInPixels.y), 1.0))), 0.0, float(hiZLevels - 1));
+        float farthest = max(max(textureLod(hiZ, minUV, level).r, textureLod(hiZ, vec2(maxUV.x, minUV.y), level).r),
+                             max(textureLod(hiZ, vec2(minUV.x, maxUV.y), level).r, textureLod(hiZ, maxUV, level).r));
+        return nearestDepth > farthest;
+    }
+
+    void main() {
+        uint i = gl_GlobalInvocationID.x;
+        if (i >= instanceCount || instances[i].batch.x == NO_BATCH)
+            return;
+
+        vec4 sphere = instances[i].sphere;
+        for (int p = 0; p < 6; ++p)
+            if (dot(frustumPlanes[p].xyz, sphere.xyz) + frustumPlanes[p].w < -sphere.w)
+                return;
+        if (useHiZ && occludedByHiZ(sphere.xyz, sphere.w))
+            return;
+
+        uint batch = instances[i].batch.x;
+        uint slot = atomicAdd(commands[batch].instanceCount, 1u);
+        visibleIndices[commands[batch].baseInstance + slot] = i;
+    }
+)glsl";
+
+static const GLchar *hiZCopySource = R"glsl(
+    #version 430 core
+    layout(local_size_x = 8, local_size_y = 8) in;
+    uniform sampler2D depthTexture;
+    layout(r32f, binding = 0) writeonly uniform image2D destination;
+
+    void main() {
+        ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+        if (any(greaterThanEqual(p, imageSize(destination))))
+            return;
+        imageStore(destination, p, vec4(texelFetch(depthTexture, p, 0).r));
+    }
+)glsl";
+
+static const GLchar *hiZReduceSource = R"glsl(
+    #version 430 core
+    layout(local_size_x = 8, local_size_y = 8) in;
+    layout(r32f, binding = 0) readonly uniform image2D source;
+    layout(r32f, binding = 1) writeonly uniform image2D destination;
+
+    void main() {
+        ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+        ivec2 destinationSize = imageSize(destination);
+        if (any(greaterThanEqual(p, destinationSize)))
+            return;
+
+        // With an odd source size the last texel also covers the extra row/column.
+        ivec2 sourceSize = imageSize(source);
+        ivec2 extent = ivec2(2) + ivec2(equal(p, destinationSize - 1)) * (sourceSize & 1);
+        float farthest = 0.0;
+        for (int y = 0; y < extent.y; ++y)
+            for (int x = 0; x < extent.x; ++x)
+                farthest = max(farthest, imageLoad(source, min(p * 2 + ivec2(x, y), sourceSize - 1)).r);
+        imageStore(destination, p, vec4(farthest));
+    }
+)glsl";
+
+static const GLchar *drawVertexSource = R"glsl(
+    #version 430 core
+    layout(location = 0) in vec3 position;
+    layout(location = 1) in vec2 texCoord;
+    layout(location = 2) in vec3 normal;
+    layout(location = 3) in uint instanceIndex;
+
+    struct Instance { mat4 model; vec4 sphere; vec4 material; uvec4 batch; };
+    layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+
+    layout(std140) uniform FrameData {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 camPos;
+        mat4 lightViewProjection;
+    };
+
+    out vec2 TexCoord;
+    out vec3 FragPos;
+    out vec3 Normal;
+    flat out vec4 Material;
+
+    void main() {
+        mat4 model = instances[instanceIndex].model;
+        FragPos = vec3(model * vec4(position, 1.0));
+        Normal = mat3(transpose(inverse(model))) * normal;
+        TexCoord = texCoord;
+        Material = instances[instanceIndex].material;
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+    }
+)glsl";
+
+// Inserted after the version line and the clustered lighting and shadow declarations.
+static const GLchar *drawFragmentSource = R"glsl(
+    in vec2 TexCoord;
+    in vec3 FragPos;
+    in vec3 Normal;
+    flat in vec4 Material;
+
+    out vec4 FragColor;
+
+    uniform sampler2D texture1;
+    layout(std140) uniform FrameData {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 camPos;
+        mat4 lightViewProjection;
+    };
+
+    void main() {
+        vec3 color = texture(texture1, TexCoord).rgb;
+        vec3 norm = normalize(Normal);
+        vec3 lightColor = vec3(1.0);
+        vec3 ambient = Material.x * lightColor;
+        vec3 lightDir = normalize(lightPos.xyz - FragPos);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = Material.y * diff * lightColor;
+        vec3 viewDir = normalize(camPos.xyz - FragPos);
+        vec3 reflectDir = reflect(-lightDir, norm);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), Material.w);
+        vec3 specular = Material.z * spec * lightColor;
+
+        vec3 pointDiffuse, pointSpecular;
+        float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+        clusteredPointLights(FragPos, norm, viewDir, viewDepth, Material, pointDiffuse, pointSpecular);
+
+        float shadow = shadowVisibility(lightViewProjection, FragPos, norm, lightDir);
+        vec3 result = (ambient + shadow * diffuse + pointDiffuse) * color + shadow * specular + pointSpecular;
+        FragColor = vec4(result, 1.0);
+    }
+)glsl";
+
+static constexpr GLsizei VERTEX_STRIDE = 8 * sizeof(GLfloat);
+// Kept clear of the texture units used by the clustered lighting buffers.
+static constexpr GLuint HI_Z_UNIT = 4;
+
+bool GpuDrivenRenderer::isSupported()
+{
+    return glExt.gpuDriven;
+}
+
+void GpuDrivenRenderer::initialize(int w, int h)
+{
+    width = w;
+    height = h;
+
+    cullProgram = buildComputeProgram(cullSource);
+    hiZCopyProgram = buildComputeProgram(hiZCopySource);
+    hiZReduceProgram = buildComputeProgram(hiZReduceSource);
+    std::string fragmentSource = std::string("#version 430 core\n") + CLUSTERED_LIGHTING_GLSL + SHADOW_MAPPING_GLSL +
+                                 drawFragmentSource;
+    drawProgram = buildShaderProgram(drawVertexSource, fragmentSource.c_str());
+    bindUniformBlock(drawProgram, "FrameData", Entity::FRAME_UNIFORM_BINDING);
+    ClusteredLighting::setupProgram(drawProgram);
+    ShadowMapper::setupProgram(drawProgram);
+
+    glState.useProgram(drawProgram);
+    glUniform1i(glGetUniformLocation(drawProgram, "texture1"), 0);
+    glState.useProgram(cullProgram);
+    glUniform1i(glGetUniformLocation(cullProgram, "hiZ"), HI_Z_UNIT);
+    glState.useProgram(hiZCopyProgram);
+    glUniform1i(glGetUniformLocation(hiZCopyProgram, "depthTexture"), HI_Z_UNIT);
+
+    createTargets();
+}
+
+void GpuDrivenRenderer::createTargets()
+{
+    glGenTextures(1, &colorTexture);
+    glState.bindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glGenTextures(1, &depthTexture);
+    glState.bindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "GPU-driven framebuffer is incomplete" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    hiZLevels = 1;
+    while ((std::max(width, height) >> hiZLevels) > 0)
+        hiZLevels++;
+
+    glGenTextures(1, &hiZTexture);
+    glState.bindTexture(GL_TEXTURE_2D, hiZTexture);
+    for (int level = 0; level < hiZLevels; ++level)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_R32F, std::max(1, width >> level), std::max(1, height >> level),
+                     0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, hiZLevels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glState.bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GpuDrivenRenderer::releaseSceneBuffers()
+{
+    for (GLuint *buffer : {&vertexBuffer, &instanceBuffer, &commandBuffer, &visibleBuffer})
+    {
+        if (*buffer)
+            glState.deleteBuffer(*buffer);
+        *buffer = 0;
+    }
+    if (vao)
+        glState.deleteVertexArray(vao);
+    vao = 0;
+}
+
+void GpuDrivenRenderer::release()
+{
+    releaseSceneBuffers();
+
+    for (GLuint *program : {&cullProgram, &drawProgram, &hiZCopyProgram, &hiZReduceProgram})
+    {
+        if (*program)
+            glState.deleteProgram(*program);
+        *program = 0;
+    }
+    for (GLuint *texture : {&colorTexture, &depthTexture, &hiZTexture})
+    {
+        if (*texture)
+            glState.deleteTexture(*texture);
+        *texture = 0;
+    }
+    if (framebuffer)
+        glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+    instances.clear();
+    sources.clear();
+    instanceCapacity = 0;
+}
+
+void GpuDrivenRenderer::setScene(const std::vector<Entity> &entities)
+{
+    releaseSceneBuffers();
+    instances.clear();
+    sources.clear();
+    instanceCapacity = 0;
+    commandTemplate.clear();
+    textureGroups.clear();
+    batchIndex.clear();
+    batchInstances.clear();
+    hiZValid = false;
+    if (entities.empty())
+        return;
+
+    // One copy of each mesh in a shared vertex buffer.
+    // Meshes that are still loading or failed have no vertices and are left out;
+    // their instances get NO_BATCH until syncScene sees the upload.
+    struct MeshRange
+    {
+        const Entity *source;
+        GLuint first;
+    };
+    std::map<GLuint, MeshRange> meshes;
+    GLuint totalVertices = 0;
+    for (const Entity &entity : entities)
+    {
+        if (entity.getVertexCount() == 0 || meshes.count(entity.getVertexBuffer()))
+            continue;
+        meshes[entity.getVertexBuffer()] = {&entity, totalVertices};
+        totalVertices += entity.getVertexCount();
+    }
+
+    glGenBuffers(1, &vertexBuffer);
+    glState.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, totalVertices * VERTEX_STRIDE, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    for (const auto &mesh : meshes)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, mesh.first);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0,
+                            mesh.second.first * VERTEX_STRIDE,
+                            mesh.second.source->getVertexCount() * VERTEX_STRIDE);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    // Batches keyed by (texture, mesh) so that batches sharing a texture are contiguous.
+    for (const Entity &entity : entities)
+        if (entity.getVertexCount() > 0)
+            batchIndex.emplace(std::make_pair(entity.getTexture(), entity.getVertexBuffer()), 0);
+
+    uint32_t next = 0;
+    for (auto &batch : batchIndex)
+    {
+        batch.second = next++;
+        const MeshRange &mesh = meshes[batch.first.second];
+        commandTemplate.push_back({static_cast<GLuint>(mesh.source->getVertexCount()), 0, mesh.first, 0});
+
+        if (textureGroups.empty() || textureGroups.back().texture != batch.first.first)
+            textureGroups.push_back({batch.first.first, batch.second, 0});
+        textureGroups.back().commandCount++;
+    }
+    batchInstances.assign(commandTemplate.size(), 0);
+
+    instances.resize(entities.size());
+    sources.resize(entities.size());
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        sources[i] = sourceOf(entities[i]);
+        writeInstance(static_cast<uint32_t>(i), entities[i], sources[i]);
+    }
+    updateBaseInstances();
+
+    glGenBuffers(1, &instanceBuffer);
+    glGenBuffers(1, &visibleBuffer);
+    reserveInstances(instances.size());
+
+    glGenBuffers(1, &commandBuffer);
+    glState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commandTemplate.size() * sizeof(DrawCommand), commandTemplate.data(), GL_DYNAMIC_DRAW);
+
+    // The visible list doubles as a per-instance attribute; baseInstance offsets it per batch.
+    glGenVertexArrays(1, &vao);
+    glState.bindVertexArray(vao);
+    glState.bindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void *)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, (void *)(5 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(2);
+    glState.bindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void *)0);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(3);
+    glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+    glState.bindVertexArray(0);
+}
+
+void GpuDrivenRenderer::syncScene(const std::vector<Entity> &entities)
+{
+    if (!vao)
+    {
+        setScene(entities);
+        return;
+    }
+
+    // Rows past the end were swap-removed; what moved into a freed row is
+    // caught below by its handle.
+    while (instances.size() > entities.size())
+    {
+        if (instances.back().batch != NO_BATCH)
+            batchInstances[instances.back().batch]--;
+        instances.pop_back();
+        sources.pop_back();
+    }
+
+    size_t oldCount = instances.size();
+    instances.resize(entities.size());
+    sources.resize(entities.size(), {EntityHandle(), 0, 0, glm::vec4(0.0f)});
+    for (size_t i = oldCount; i < instances.size(); ++i)
+        instances[i].batch = NO_BATCH;
+
+    size_t firstDirty = instances.size(), endDirty = 0;
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        InstanceSource source = sourceOf(entities[i]);
+        const InstanceSource &previous = sources[i];
+        if (source.handle == previous.handle && source.vertexBuffer == previous.vertexBuffer &&
+            source.texture == previous.texture && source.material == previous.material)
+            continue;
+
+        // A mesh or texture the merged buffers lack.
+        if (source.vertexBuffer && !batchIndex.count(std::make_pair(source.texture, source.vertexBuffer)))
+        {
+            setScene(entities);
+            return;
+        }
+
+        if (instances[i].batch != NO_BATCH)
+            batchInstances[instances[i].batch]--;
+        sources[i] = source;
+        writeInstance(static_cast<uint32_t>(i), entities[i], source);
+        firstDirty = std::min(firstDirty, i);
+        endDirty = i + 1;
+    }
+    updateBaseInstances();
+
+    if (instances.size() > instanceCapacity)
+        reserveInstances(std::max(instances.size(), instanceCapacity * 2));
+    else if (firstDirty < endDirty)
+    {
+        glState.bindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, firstDirty * sizeof(GpuInstance),
+                        (endDirty - firstDirty) * sizeof(GpuInstance), &instances[firstDirty]);
+    }
+}
+
+GpuDrivenRenderer::InstanceSource GpuDrivenRenderer::sourceOf(const Entity &entity) const
+{
+    GLuint mesh = entity.getVertexCount() > 0 ? entity.getVertexBuffer() : 0;
+    return {entity.getHandle(), mesh, entity.getTexture(), entity.getMaterial()};
+}
+
+// Fills the instance and counts it in its batch; the caller uploads it.
+void GpuDrivenRenderer::writeInstance(uint32_t index, const Entity &entity, const InstanceSource &source)
+{
+    uint32_t batch = NO_BATCH;
+    if (source.vertexBuffer)
+    {
+        batch = batchIndex.at(std::make_pair(source.texture, source.vertexBuffer));
+        batchInstances[batch]++;
+    }
+
+    GpuInstance &instance = instances[index];
+    BoundingSphere sphere = entity.getWorldBoundingSphere();
+    instance.model = entity.getModelMatrix();
+    instance.sphere = glm::vec4(sphere.center, sphere.radius);
+    instance.material = source.material;
+    instance.batch = batch;
+}
+
+// Each batch's slice of the visible list starts after the previous batches.
+void GpuDrivenRenderer::updateBaseInstances()
+{
+    GLuint baseInstance = 0;
+    for (size_t b = 0; b < commandTemplate.size(); ++b)
+    {
+        commandTemplate[b].baseInstance = baseInstance;
+        baseInstance += batchInstances[b];
+    }
+}
+
+// Reallocates the instance and visible buffers for count instances and
+// uploads all instances. The buffer names stay, so the VAO keeps them.
+void GpuDrivenRenderer::reserveInstances(size_t count)
+{
+    instanceCapacity = count;
+
+    glState.bindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, instanceCapacity * sizeof(GpuInstance), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, instances.size() * sizeof(GpuInstance), instances.data());
+
+    glState.bindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GpuDrivenRenderer::updateInstance(uint32_t index, const Entity &entity)
+{
+    if (index >= instances.size())
+        return;
+
+    GpuInstance &instance = instances[index];
+    BoundingSphere sphere = entity.getWorldBoundingSphere();
+    instance.model = entity.getModelMatrix();
+    instance.sphere = glm::vec4(sphere.center, sphere.radius);
+
+    glState.bindBuffer(GL_SHADER_STORAGE_BUFFER, instanceBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, index * sizeof(GpuInstance),
+                    sizeof(glm::mat4) + sizeof(glm::vec4), &instance);
+}
+
+void GpuDrivenRenderer::render(const Frustum &frustum, const glm::mat4 &viewProjection)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    if (!instances.empty())
+    {
+        glState.bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandTemplate.size() * sizeof(DrawCommand), commandTemplate.data());
+
+        glState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, instanceBuffer);
+        glState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, commandBuffer);
+        glState.bindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_BINDING, visibleBuffer);
+
+        glState.useProgram(cullProgram);
+        glUniform1ui(glGetUniformLocation(cullProgram, "instanceCount"), static_cast<GLuint>(instances.size()));
+        glUniform4fv(glGetUniformLocation(cullProgram, "frustumPlanes"), Frustum::COUNT, glm::value_ptr(frustum.planes[0]));
+        glUniform1i(glGetUniformLocation(cullProgram, "useHiZ"), hiZValid);
+        glUniformMatrix4fv(glGetUniformLocation(cullProgram, "previousViewProjection"), 1, GL_FALSE, glm::value_ptr(previousViewProjection));
+        glUniform2f(glGetUniformLocation(cullProgram, "hiZSize"), (float)width, (float)height);
+        glUniform1i(glGetUniformLocation(cullProgram, "hiZLevels"), hiZLevels);
+        glState.bindTextureUnit(HI_Z_UNIT, GL_TEXTURE_2D, hiZTexture);
+
+        glExt.DispatchCompute((static_cast<GLuint>(instances.size()) + 63) / 64, 1, 1);
+        glExt.MemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glState.useProgram(drawProgram);
+        glState.bindVertexArray(vao);
+        for (const TextureGroup &group : textureGroups)
+        {
+            glState.bindTextureUnit(0, GL_TEXTURE_2D, group.texture);
+            glExt.MultiDrawArraysIndirect(GL_TRIANGLES, (void *)(group.firstCommand * sizeof(DrawCommand)),
+                                          group.commandCount, 0);
+            glState.countDrawCall();
+        }
+    }
+
+    buildHiZ();
+    previousViewProjection = viewProjection;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void GpuDrivenRenderer::buildHiZ()
+{
+    glState.useProgram(hiZCopyProgram);
+    glState.bindTextureUnit(HI_Z_UNIT, GL_TEXTURE_2D, depthTexture);
+    glExt.BindImageTexture(0, hiZTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glExt.DispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+
+    glState.useProgram(hiZReduceProgram);
+    for (int level = 1; level < hiZLevels; ++level)
+    {
+        glExt.MemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        int w = std::max(1, width >> level);
+        int h = std::max(1, height >> level);
+        glExt.BindImageTexture(0, hiZTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glExt.BindImageTexture(1, hiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glExt.DispatchCompute((w + 7) / 8, (h + 7) / 8, 1);
+    }
+    glExt.MemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    hiZValid = true;
+}
+
+void GpuDrivenRenderer::printStats() const
+{
+    std::cout << "GPU-driven: " << instances.size() << " instances, " << commandTemplate.size()
+              << " indirect commands, " << textureGroups.size() << " multi-draw calls, Hi-Z "
+              << hiZLevels << " levels" << std::endl;
+}
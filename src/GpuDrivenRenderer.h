@@ -0,0 +1,114 @@
+#ifndef GPU_DRIVEN_RENDERER_H
+#define GPU_DRIVEN_RENDERER_H
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+#include "EntityStore.h"
+
+class Entity;
+
+// GL 4.3 path where the CPU never looks at individual instances per frame.
+// Instance transforms/bounds live in an SSBO; a compute shader frustum- and
+// Hi-Z-culls them and appends survivors to a visible list while atomically
+// bumping instanceCount in one indirect command per (mesh, texture) batch.
+// Drawing is one glMultiDrawArraysIndirect per texture, so the CPU cost only
+// depends on the number of distinct textures.
+//
+// Only core GL 4.3 is required (no ARB_indirect_parameters), which Mesa's
+// llvmpipe provides.
+class GpuDrivenRenderer
+{
+public:
+    static bool isSupported();
+
+    void initialize(int width, int height);
+    void release();
+
+    // Rebuilds merged geometry, batches and instance data from the entity list.
+    void setScene(const std::vector<Entity> &entities);
+    // Brings the instances in line with the entity list after rows were added,
+    // removed or got new assets. Only the changed instances are uploaded; the
+    // geometry is merged again only for a (texture, mesh) pair it lacks.
+    void syncScene(const std::vector<Entity> &entities);
+    void updateInstance(uint32_t index, const Entity &entity);
+    size_t instanceCount() const { return instances.size(); }
+
+    // Expects FrameData, ClusterData and the light buffers to be bound already.
+    void render(const Frustum &frustum, const glm::mat4 &viewProjection);
+
+    void printStats() const;
+
+private:
+    struct GpuInstance
+    {
+        glm::mat4 model;
+        glm::vec4 sphere; // world center, radius
+        glm::vec4 material;
+        uint32_t batch;
+        uint32_t padding[3];
+    };
+
+    // What an instance was built from, to spot rows that changed since.
+    struct InstanceSource
+    {
+        EntityHandle handle;
+        GLuint vertexBuffer; // 0 while the mesh has no vertices
+        GLuint texture;
+        glm::vec4 material;
+    };
+
+    struct DrawCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint first;
+        GLuint baseInstance;
+    };
+
+    struct TextureGroup
+    {
+        GLuint texture;
+        GLuint firstCommand;
+        GLsizei commandCount;
+    };
+
+    static constexpr uint32_t NO_BATCH = 0xFFFFFFFFu; // instance without geometry, never drawn
+    static constexpr GLuint INSTANCE_BINDING = 0;
+    static constexpr GLuint COMMAND_BINDING = 1;
+    static constexpr GLuint VISIBLE_BINDING = 2;
+
+    int width = 0, height = 0;
+
+    std::vector<GpuInstance> instances;
+    std::vector<InstanceSource> sources;
+    size_t instanceCapacity = 0; // of the instance and visible buffers
+    std::vector<DrawCommand> commandTemplate;
+    std::vector<TextureGroup> textureGroups;
+    std::map<std::pair<GLuint, GLuint>, uint32_t> batchIndex; // (texture, vertex buffer) -> batch
+    std::vector<GLuint> batchInstances;
+
+    GLuint cullProgram = 0, drawProgram = 0, hiZCopyProgram = 0, hiZReduceProgram = 0;
+    GLuint vertexBuffer = 0, instanceBuffer = 0, commandBuffer = 0, visibleBuffer = 0;
+    GLuint vao = 0;
+
+    GLuint framebuffer = 0, colorTexture = 0, depthTexture = 0;
+    GLuint hiZTexture = 0;
+    int hiZLevels = 0;
+    bool hiZValid = false;
+    glm::mat4 previousViewProjection = glm::mat4(1.0f);
+
+    void createTargets();
+    void buildHiZ();
+    void releaseSceneBuffers();
+    InstanceSource sourceOf(const Entity &entity) const;
+    void writeInstance(uint32_t index, const Entity &entity, const InstanceSource &source);
+    void updateBaseInstances();
+    void reserveInstances(size_t count);
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "GpuQueryRing.h"
+
+void GpuQueryRing::initialize()
+{
+    glGenQueries(SIZE, queries);
+}
+
+void GpuQueryRing::release()
+{
+    if (queries[0])
+        glDeleteQueries(SIZE, queries);
+    for (int i = 0; i < SIZE; ++i)
+    {
+        queries[i] = 0;
+        issued[i] = false;
+    }
+}
+
+void GpuQueryRing::begin()
+{
+    glBeginQuery(target, queries[next]);
+    active = true;
+}
+
+void GpuQueryRing::end()
+{
+    if (!active)
+        return;
+    glEndQuery(target);
+    issued[next] = true;
+    next = (next + 1) % SIZE;
+    active = false;
+}
+
+bool GpuQueryRing::latest(GLuint64 &value) const
+{
+    // Walk from the newest issued query back to the oldest.
+    for (int age = 1; age <= SIZE; ++age)
+    {
+        int slot = (next - age + SIZE) % SIZE;
+        if (!issued[slot] || (active && slot == next))
+            continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &lastResult);
+            hasResult = true;
+            break;
+        }
+    }
+
+    value = lastResult;
+    return hasResult;
+}
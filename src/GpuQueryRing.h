@@ -0,0 +1,35 @@
+#ifndef GPU_QUERY_RING_H
+#define GPU_QUERY_RING_H
+
+#include <glad/glad.h>
+
+// A few query objects of one target used round-robin, so results of earlier
+// frames can be read once available without ever blocking on the GPU.
+class GpuQueryRing
+{
+public:
+    explicit GpuQueryRing(GLenum target) : target(target) {}
+
+    void initialize();
+    void release();
+
+    void begin();
+    void end();
+
+    // Most recent result that has come back (false until the first one does).
+    bool latest(GLuint64 &value) const;
+
+private:
+    static constexpr int SIZE = 4;
+
+    GLenum target;
+    GLuint queries[SIZE] = {};
+    bool issued[SIZE] = {};
+    int next = 0;
+    bool active = false;
+
+    mutable bool hasResult = false;
+    mutable GLuint64 lastResult = 0;
+};
+
+#endif
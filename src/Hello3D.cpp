@@ -7,17 +7,112 @@
 #include <glm/gtc/type_ptr.hpp>
 #include "Entity.h"
 #include "Camera.h"
-#include "json.hpp"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "StreamRingBuffer.h"
+#include "FrustumCuller.h"
+#include "SceneBVH.h"
+#include "OcclusionCuller.h"
+#include "DepthPrepass.h"
+#include "GpuDrivenRenderer.h"
+#include "ClusteredLighting.h"
+#include "DeferredRenderer.h"
+#include "GpuQueryRing.h"
+#include "ShadowMapper.h"
+#include "DynamicResolution.h"
+#include "SceneFile.h"
+#include "SceneStream.h"
+#include "AssetLoader.h"
+#include "AssetManager.h"
+#include "FileWatcher.h"
+#include "WorldPartition.h"
+#include "LinearArena.h"
+#include "AllocationCounter.h"
+#include "SimulationClock.h"
+#include "TrajectoryBatch.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
 #include <fstream>
 
-using json = nlohmann::json;
-
 const GLuint WIDTH = 1000, HEIGHT = 1000;
 int selectedEntityIndex = 0;
 std::vector<Entity> entities;
 
 Camera camera;
-glm::vec3 lightPos;
+glm::vec3 lightPos = SCENE_DEFAULT_KEY_LIGHT;
+std::vector<PointLight> pointLights;
+ClusteredLighting clusteredLighting;
+
+SceneBVH sceneBVH;
+FrustumCuller frustumCuller;
+bool bvhCulling = true;
+std::vector<uint32_t> visibleEntities;
+std::vector<uint32_t> changedEntities;
+
+OcclusionCuller occlusionCuller;
+bool occlusionCulling = false;
+
+DepthPrepass depthPrepass;
+bool depthPrepassEnabled = false;
+
+GpuDrivenRenderer gpuRenderer;
+bool gpuDriven = false;
+
+DeferredRenderer deferredRenderer;
+bool deferredShading = false;
+
+GpuQueryRing sceneTimer(GL_TIME_ELAPSED);
+
+ShadowMapper shadowMapper;
+
+DynamicResolution dynamicResolution;
+
+AssetLoader assetLoader;
+// At most this many finished loads are uploaded per frame after startup.
+const size_t UPLOADS_PER_FRAME = 8;
+
+FileWatcher sceneWatcher;
+std::string watchedSceneFile;
+// Entities were added, removed or re-textured: spatial structures need a rebuild.
+bool sceneStructureChanged = false;
+// (child key, parent key) pairs whose parent is still loading.
+std::vector<std::pair<std::string, std::string>> pendingAttachments;
+// Entities added by a reload whose load has not completed, by scene key. A
+// completion whose key is gone, or whose request was superseded, is dropped.
+struct PendingSceneAdd
+{
+    uint32_t request;
+    SceneEntityDescription description;
+};
+std::unordered_map<std::string, PendingSceneAdd> pendingSceneAdds;
+uint32_t nextSceneAddRequest = 0;
+
+WorldPartition worldPartition;
+SimulationClock simulationClock;
+
+// Headless benchmark (--benchmark N): hidden window, no vsync, N frames
+// measured after a warm-up, then one CSV line is appended and the app exits.
+struct BenchmarkRun
+{
+    int frames = 0;
+    std::string csvFile = "benchmark.csv";
+    double loadMs = 0.0;
+    int frameIndex = 0;
+    double lastFrameTime = 0.0;
+    double frameMsSum = 0.0, frameMsMax = 0.0;
+    double gpuMsSum = 0.0;
+    int gpuSamples = 0;
+    double drawCallSum = 0.0;
+    double allocationSum = 0.0;
+};
+BenchmarkRun benchmark;
+const int BENCHMARK_WARMUP_FRAMES = 30;
+// Heap allocations made during the previous frame, and the counter at its start.
+size_t lastFrameAllocations = 0;
+size_t frameStartAllocations = 0;
+// Scene GPU time of the latest resolved frame, or negative when none is available.
+double lastSceneGpuMs = -1.0;
 
 float lastX = WIDTH / 2.0f;
 float lastY = HEIGHT / 2.0f;
@@ -25,10 +120,42 @@ bool firstMouse = true;
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 void mouse_callback(GLFWwindow *window, double xpos, double ypos);
+void loadScene(const std::string &sceneFile);
 void loadSceneFromJSON(const std::string &jsonFile);
-
-int main()
+bool loadSceneFromBinary(const std::string &sceneFile);
+std::string sceneKeyFor(const SceneEntityDescription &description, size_t index);
+Entity &createSceneEntity(const SceneEntityDescription &description, const std::string &sceneKey);
+uint32_t addSceneEntity(const SceneEntityDescription &description, const std::string &sceneKey);
+void reloadScene(const std::string &jsonFile);
+void removeEntity(uint32_t row);
+void sortFrontToBack(std::vector<uint32_t> &indices, const glm::vec3 &cameraPosition);
+void rebuildSceneBVH();
+void recordBenchmarkFrame(GLFWwindow *window);
+void advanceTrajectories(float tickSeconds);
+
+int main(int argc, char **argv)
 {
+    bool requestGpuDriven = false;
+    std::string sceneFile = "../assets/scene.json";
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--gpu-driven")
+            requestGpuDriven = true;
+        else if (arg == "--deferred")
+            deferredShading = true;
+        else if (arg == "--target-ms" && i + 1 < argc)
+            dynamicResolution.setTargetMilliseconds(std::stof(argv[++i]));
+        else if (arg == "--tick-hz" && i + 1 < argc)
+            simulationClock.setTickRate(std::stod(argv[++i]));
+        else if (arg == "--scene" && i + 1 < argc)
+            sceneFile = argv[++i];
+        else if (arg == "--benchmark" && i + 1 < argc)
+            benchmark.frames = std::stoi(argv[++i]);
+        else if (arg == "--benchmark-csv" && i + 1 < argc)
+            benchmark.csvFile = argv[++i];
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
@@ -36,13 +163,16 @@ int main()
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (benchmark.frames > 0)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "GB - Inara Valentim :)", nullptr, nullptr);
     glfwMakeContextCurrent(window);
 
     glfwSetKeyCallback(window, key_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (benchmark.frames == 0)
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
@@ -50,13 +180,64 @@ int main()
         return -1;
     }
 
-    glEnable(GL_DEPTH_TEST);
+    loadGLExtensions();
 
-    loadSceneFromJSON("../assets/scene.json");
+    glEnable(GL_DEPTH_TEST);
+    if (benchmark.frames > 0)
+        glfwSwapInterval(0);
+
+    double loadStart = glfwGetTime();
+    assetLoader.start();
+    assetManager.setLoader(&assetLoader);
+    loadScene(sceneFile);
+    benchmark.loadMs = (glfwGetTime() - loadStart) * 1000.0;
+    // Streamed worlds are not diffed: most of their entities are not resident.
+    if (sceneFile.size() >= 5 && sceneFile.compare(sceneFile.size() - 5, 5, ".json") == 0 &&
+        !worldPartition.isEnabled() && sceneWatcher.watch(sceneFile))
+        watchedSceneFile = sceneFile;
+
+    StreamRingBuffer uniformRing(3);
+    occlusionCuller.initialize();
+    depthPrepass.initialize();
+
+    int framebufferWidth, framebufferHeight;
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+    clusteredLighting.initialize();
+    clusteredLighting.setLights(pointLights);
+    sceneTimer.initialize();
+    shadowMapper.initialize();
+    dynamicResolution.initialize(framebufferWidth, framebufferHeight);
+    if (deferredShading)
+        deferredRenderer.initialize(framebufferWidth, framebufferHeight);
+
+    if (GpuDrivenRenderer::isSupported())
+    {
+        gpuRenderer.initialize(framebufferWidth, framebufferHeight);
+        gpuDriven = requestGpuDriven;
+    }
+    else if (requestGpuDriven)
+    {
+        std::cerr << "GPU-driven rendering needs OpenGL 4.3" << std::endl;
+    }
 
     while (!glfwWindowShouldClose(window))
     {
         glfwPollEvents();
+        int simulationTicks = simulationClock.advance(glfwGetTime());
+        glState.beginFrame();
+        frameArena.beginFrame();
+        size_t allocationCount = heapAllocationCount();
+        lastFrameAllocations = allocationCount - frameStartAllocations;
+        frameStartAllocations = allocationCount;
+        if (benchmark.frames > 0)
+            recordBenchmarkFrame(window);
+        assetManager.endFrame();
+
+        if (sceneWatcher.poll())
+            reloadScene(watchedSceneFile);
+        worldPartition.update(camera.position, assetLoader);
+        if (assetLoader.pumpUploads(UPLOADS_PER_FRAME) > 0)
+            sceneStructureChanged = true;
 
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -64,17 +245,145 @@ int main()
         glm::mat4 view = camera.getViewMatrix();
         glm::mat4 projection = glm::perspective(glm::radians(camera.fov), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
 
-        for (auto &entity : entities)
+        uniformRing.reserve(uniformRing.alignedSize(sizeof(FrameUniforms)) +
+                            uniformRing.alignedSize(sizeof(ClusterUniforms)) +
+                            entities.size() * uniformRing.alignedSize(sizeof(ObjectUniforms)));
+        uniformRing.beginFrame();
+
+        GLintptr frameOffset;
+        FrameUniforms *frame = uniformRing.allocate<FrameUniforms>(frameOffset);
+        if (frame)
         {
-        
-            entity.updateBezierTrajectory();
-            entity.setViewProjection(view, projection, camera.position);
-            entity.draw(lightPos);
+            frame->view = view;
+            frame->projection = projection;
+            frame->lightPos = glm::vec4(lightPos, 1.0f);
+            frame->camPos = glm::vec4(camera.position, 1.0f);
+            uniformRing.bindRange(Entity::FRAME_UNIFORM_BINDING, frameOffset, sizeof(FrameUniforms));
         }
 
+        // The GPU-driven path always renders at full resolution.
+        int sceneWidth = gpuDriven ? framebufferWidth : dynamicResolution.viewportWidth();
+        int sceneHeight = gpuDriven ? framebufferHeight : dynamicResolution.viewportHeight();
+        clusteredLighting.update(view, glm::radians(camera.fov), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f,
+                                 sceneWidth, sceneHeight);
+        clusteredLighting.bind();
+        GLintptr clusterOffset;
+        if (ClusterUniforms *clusters = uniformRing.allocate<ClusterUniforms>(clusterOffset))
+        {
+            *clusters = clusteredLighting.uniforms();
+            uniformRing.bindRange(Entity::CLUSTER_UNIFORM_BINDING, clusterOffset, sizeof(ClusterUniforms));
+        }
+
+        // Trajectories advance in fixed simulation ticks, all followers in one
+        // batch; frames between ticks just interpolate in the transform pass,
+        // which streams the SoA columns of animated or edited rows.
+        for (int tick = 0; tick < simulationTicks; ++tick)
+            advanceTrajectories(simulationClock.tickSeconds());
+        changedEntities.clear();
+        entityStore.updateTransforms(static_cast<float>(simulationClock.renderTime()), simulationClock.alpha(),
+                                     changedEntities);
+
+        bool sceneRebuild = sceneStructureChanged || sceneBVH.objectCount() != entities.size();
+        sceneStructureChanged = false;
+        if (sceneRebuild)
+        {
+            rebuildSceneBVH();
+            shadowMapper.invalidateStatic();
+        }
+        for (uint32_t row : changedEntities)
+        {
+            const Entity &entity = entities[row];
+            sceneBVH.updateObject(row, entity.getWorldAABB());
+            shadowMapper.objectMoved(entity);
+            if (gpuDriven)
+                gpuRenderer.updateInstance(row, entity);
+        }
+        sceneBVH.rebuildIfDegraded();
+
+        shadowMapper.update(entities, lightPos, uniformRing);
+        shadowMapper.bind();
+        if (frame)
+            frame->lightViewProjection = shadowMapper.lightViewProjection();
+
+        if (gpuDriven)
+        {
+            // Culling and draw-command generation happen entirely on the GPU.
+            if (sceneRebuild || gpuRenderer.instanceCount() != entities.size())
+                gpuRenderer.syncScene(entities);
+            gpuRenderer.render(Camera::extractFrustum(projection * view), projection * view);
+            uniformRing.endFrame();
+            glfwSwapBuffers(window);
+            continue;
+        }
+
+        visibleEntities.clear();
+        Frustum frustum = Camera::extractFrustum(projection * view);
+        if (bvhCulling)
+        {
+            sceneBVH.queryFrustum(frustum, visibleEntities);
+        }
+        else
+        {
+            frustumCuller.resize(entities.size());
+            for (size_t i = 0; i < entities.size(); ++i)
+                frustumCuller.setSphere(i, entities[i].getWorldBoundingSphere());
+            frustumCuller.cull(frustum, visibleEntities);
+        }
+        sortFrontToBack(visibleEntities, camera.position);
+
+        GLuint sceneFramebuffer = dynamicResolution.beginScene();
+        sceneTimer.begin();
+        depthPrepass.beginStatistics();
+        if (deferredShading)
+        {
+            deferredRenderer.render(entities, visibleEntities, uniformRing, projection * view, sceneFramebuffer,
+                                    sceneWidth, sceneHeight);
+        }
+        else if (occlusionCulling)
+        {
+            occlusionCuller.render(entities, visibleEntities, uniformRing, camera.position);
+        }
+        else if (depthPrepassEnabled)
+        {
+            depthPrepass.renderDepth(entities, visibleEntities, uniformRing);
+            depthPrepass.beginShading();
+            for (uint32_t index : visibleEntities)
+                entities[index].draw(uniformRing);
+            depthPrepass.endShading();
+        }
+        else
+        {
+            for (uint32_t index : visibleEntities)
+                entities[index].draw(uniformRing);
+        }
+        depthPrepass.endStatistics();
+        sceneTimer.end();
+
+        GLuint64 sceneNanoseconds;
+        if (sceneTimer.latest(sceneNanoseconds))
+        {
+            lastSceneGpuMs = sceneNanoseconds / 1.0e6;
+            dynamicResolution.update(lastSceneGpuMs);
+        }
+        dynamicResolution.endScene();
+
+        uniformRing.endFrame();
+
         glfwSwapBuffers(window);
     }
 
+    assetLoader.stop();
+    assetManager.releaseAll();
+    gpuRenderer.release();
+    deferredRenderer.release();
+    sceneTimer.release();
+    shadowMapper.release();
+    dynamicResolution.release();
+    clusteredLighting.release();
+    depthPrepass.release();
+    occlusionCuller.release();
+    uniformRing.release();
+
     glfwDestroyWindow(window);
     glfwTerminate();
     return 0;
@@ -96,6 +405,94 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
         if (key == GLFW_KEY_D)
             camera.processKeyboard('D');
 
+        if (key == GLFW_KEY_P && action == GLFW_PRESS)
+        {
+            glState.printStats();
+            std::cout << "Frustum culling: " << visibleEntities.size() << "/" << entities.size() << " visible ("
+                      << (bvhCulling ? "BVH" : (FrustumCuller::hasSIMD() ? "AVX2 scan" : "scalar scan")) << ")" << std::endl;
+            std::cout << "BVH: SAH cost ratio " << sceneBVH.costRatio() << ", " << sceneBVH.rebuildCount() << " builds" << std::endl;
+            if (occlusionCulling)
+                occlusionCuller.printStats();
+            depthPrepass.printStats(depthPrepassEnabled);
+            clusteredLighting.printStats();
+            shadowMapper.printStats();
+            dynamicResolution.printStats();
+            assetLoader.printStats();
+            assetManager.printStats();
+            worldPartition.printStats();
+            simulationClock.printStats();
+            trajectoryBatch.printStats();
+            frameArena.printStats();
+            std::cout << "Heap allocations last frame: " << lastFrameAllocations << std::endl;
+            GLuint64 sceneTime;
+            if (sceneTimer.latest(sceneTime))
+                std::cout << "Scene GPU time: " << sceneTime / 1.0e6 << " ms ("
+                          << (deferredShading ? "deferred" : "forward") << ")" << std::endl;
+            if (deferredShading)
+                deferredRenderer.printStats();
+            if (gpuDriven)
+                gpuRenderer.printStats();
+        }
+
+        if (key == GLFW_KEY_G && action == GLFW_PRESS)
+        {
+            if (!GpuDrivenRenderer::isSupported())
+            {
+                std::cout << "GPU-driven rendering needs OpenGL 4.3" << std::endl;
+            }
+            else
+            {
+                gpuDriven = !gpuDriven;
+                if (gpuDriven)
+                    gpuRenderer.setScene(entities);
+                std::cout << "GPU-driven rendering " << (gpuDriven ? "on" : "off") << std::endl;
+            }
+        }
+
+        // The box tests of the occlusion pass need a writable LESS depth test,
+        // so the two modes are mutually exclusive.
+        if (key == GLFW_KEY_O && action == GLFW_PRESS)
+        {
+            occlusionCulling = !occlusionCulling;
+            if (occlusionCulling)
+                depthPrepassEnabled = false;
+            std::cout << "Occlusion culling " << (occlusionCulling ? "on" : "off") << std::endl;
+        }
+
+        if (key == GLFW_KEY_R && action == GLFW_PRESS)
+        {
+            dynamicResolution.setEnabled(!dynamicResolution.isEnabled());
+            std::cout << "Dynamic resolution " << (dynamicResolution.isEnabled() ? "on" : "off") << std::endl;
+        }
+
+        if (key == GLFW_KEY_B && action == GLFW_PRESS)
+        {
+            bvhCulling = !bvhCulling;
+            std::cout << "Frustum culling via " << (bvhCulling ? "BVH" : "linear scan") << std::endl;
+        }
+
+        if (key == GLFW_KEY_F && action == GLFW_PRESS)
+        {
+            uint32_t hit;
+            float distance;
+            if (sceneBVH.raycast(camera.position, camera.front, hit, distance))
+            {
+                selectedEntityIndex = static_cast<int>(hit);
+                std::cout << "Picked entity " << hit << " at distance " << distance << std::endl;
+            }
+        }
+
+        if (key == GLFW_KEY_V && action == GLFW_PRESS)
+        {
+            depthPrepassEnabled = !depthPrepassEnabled;
+            if (depthPrepassEnabled)
+                occlusionCulling = false;
+            std::cout << "Depth pre-pass " << (depthPrepassEnabled ? "on" : "off") << std::endl;
+        }
+
+        // A reload can leave the scene empty.
+        if (entities.empty())
+            return;
         Entity &selectedEntity = entities[selectedEntityIndex];
 
         if (key == GLFW_KEY_X)
@@ -138,46 +535,486 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos)
     camera.processMouseMovement(xoffset, yoffset);
 }
 
+// Compiled .scene files are mapped directly; anything else is parsed as JSON.
+void loadScene(const std::string &sceneFile)
+{
+    const std::string extension = ".scene";
+    bool compiled = sceneFile.size() >= extension.size() &&
+                    sceneFile.compare(sceneFile.size() - extension.size(), extension.size(), extension) == 0;
+    if (compiled)
+        loadSceneFromBinary(sceneFile);
+    else
+        loadSceneFromJSON(sceneFile);
+
+    // Entities reference their rows right away; draw only once every asset is in.
+    assetLoader.finish();
+    assetLoader.printStats();
+}
+
+std::string sceneKeyFor(const SceneEntityDescription &description, size_t index)
+{
+    return description.name.empty() ? "#" + std::to_string(index) : description.name;
+}
+
+Entity &createSceneEntity(const SceneEntityDescription &description, const std::string &sceneKey)
+{
+    const glm::vec3 &position = description.position;
+    entities.emplace_back(position.x, position.y, position.z, glm::vec3(0.0f, 0.0f, 0.0f), description.scale,
+                          description.obj, description.mtl, description.texture, description.rotation);
+    entities.back().setAssetPaths(description.obj, description.mtl, description.texture, description.trajectory);
+    entities.back().setSceneKey(sceneKey);
+    entities.back().acquireAssets();
+    if (description.rotateAxis)
+        entities.back().setRotateAxis(description.rotateAxis);
+    entities.back().setTrajectorySpeed(description.speed);
+    return entities.back();
+}
+
+uint32_t addSceneEntity(const SceneEntityDescription &description, const std::string &sceneKey)
+{
+    createSceneEntity(description, sceneKey);
+    size_t index = entities.size() - 1;
+
+    // Shared assets were queued by acquireAssets(); only the material is the
+    // entity's own. GL uploads for whatever finished meanwhile run here,
+    // overlapping with the scene parse.
+    EntityAssetRequest request;
+    request.mtlFile = description.mtl;
+    assetLoader.enqueue(request, [index](EntityAssetData &data)
+                        { entities[index].initialize(data); });
+    assetLoader.pumpUploads();
+    return entities.back().row();
+}
+
+bool loadSceneFromBinary(const std::string &sceneFile)
+{
+    SceneFile file;
+    if (!file.open(sceneFile))
+        return false;
+
+    const SceneFileHeader &header = file.header();
+    camera.position = glm::vec3(header.cameraPosition[0], header.cameraPosition[1], header.cameraPosition[2]);
+    camera.front = glm::vec3(header.cameraFront[0], header.cameraFront[1], header.cameraFront[2]);
+    camera.up = glm::vec3(header.cameraUp[0], header.cameraUp[1], header.cameraUp[2]);
+    camera.fov = header.cameraFov;
+    lightPos = glm::vec3(header.keyLightPosition[0], header.keyLightPosition[1], header.keyLightPosition[2]);
+
+    const SceneLightRecord *lights = file.lights();
+    for (uint32_t i = 0; i < header.lightCount; ++i)
+    {
+        PointLight pointLight;
+        pointLight.position = glm::vec3(lights[i].position[0], lights[i].position[1], lights[i].position[2]);
+        pointLight.radius = lights[i].radius;
+        pointLight.color = glm::vec3(lights[i].color[0], lights[i].color[1], lights[i].color[2]);
+        pointLights.push_back(pointLight);
+    }
+
+    const SceneEntityRecord *records = file.entities();
+    uint32_t firstRow = static_cast<uint32_t>(entities.size());
+    entities.reserve(entities.size() + header.entityCount);
+    for (uint32_t i = 0; i < header.entityCount; ++i)
+    {
+        const SceneEntityRecord &record = records[i];
+        SceneEntityDescription description;
+        description.name = file.string(record.name);
+        description.obj = file.string(record.obj);
+        description.mtl = file.string(record.mtl);
+        description.texture = file.string(record.texture);
+        description.trajectory = file.string(record.trajectory);
+        description.position = glm::vec3(record.position[0], record.position[1], record.position[2]);
+        description.rotation = glm::vec3(record.rotation[0], record.rotation[1], record.rotation[2]);
+        description.scale = record.scale;
+        description.rotateAxis = static_cast<char>(record.rotateAxis);
+        description.speed = record.speed;
+        addSceneEntity(description, sceneKeyFor(description, i));
+    }
+    for (uint32_t i = 0; i < header.entityCount; ++i)
+    {
+        if (records[i].parent != SCENE_NO_PARENT && records[i].parent < header.entityCount)
+            entityStore.setParent(firstRow + i, firstRow + records[i].parent);
+    }
+    return true;
+}
+
+// Streams the file through the SAX parser: each entity is created, and its
+// assets loaded, as soon as its object closes.
 void loadSceneFromJSON(const std::string &jsonFile)
 {
-    std::ifstream file(jsonFile);
-    if (!file.is_open())
+    // Entities may name themselves and attach to a named parent; the child's
+    // position, rotation and scale are then relative to the parent's frame.
+    std::unordered_map<std::string, uint32_t> namedRows;
+    std::vector<std::pair<uint32_t, std::string>> attachments;
+
+    SceneStreamHandlers handlers;
+    handlers.onCamera = [](const SceneCameraDescription &description)
+    {
+        camera.position = description.position;
+        camera.front = description.front;
+        camera.up = description.up;
+        camera.fov = description.fov;
+    };
+    handlers.onKeyLight = [](const glm::vec3 &position)
+    { lightPos = position; };
+    // Optional point lights, shaded through the clustered light lists.
+    handlers.onLight = [](const SceneLightDescription &light)
+    {
+        PointLight pointLight;
+        pointLight.position = light.position;
+        pointLight.radius = light.radius;
+        pointLight.color = light.color;
+        pointLights.push_back(pointLight);
+    };
+    // With a "partition" object (declared before "entities"), entities are only
+    // bucketed here and streamed in around the camera at runtime.
+    handlers.onPartition = [&](const ScenePartitionDescription &partition)
+    {
+        auto spawn = [](const SceneEntityDescription &description, EntityAssetData &data)
+        {
+            Entity &entity = createSceneEntity(description, description.name);
+            entity.initialize(data);
+            sceneStructureChanged = true;
+            return entity.getHandle();
+        };
+        auto despawn = [](EntityHandle handle)
+        {
+            if (entityStore.isValid(handle))
+                removeEntity(entityStore.row(handle));
+        };
+        auto settled = [](EntityHandle handle)
+        {
+            return !entityStore.isValid(handle) || entities[entityStore.row(handle)].assetsSettled();
+        };
+        worldPartition.configure(partition, spawn, despawn, settled);
+    };
+
+    size_t entityIndex = 0;
+    handlers.onEntity = [&](const SceneEntityDescription &description)
+    {
+        if (worldPartition.isEnabled())
+        {
+            if (!description.parent.empty())
+                std::cerr << "Parents are ignored in a partitioned scene: " << description.name << std::endl;
+            worldPartition.addEntity(description);
+            return;
+        }
+        uint32_t r = addSceneEntity(description, sceneKeyFor(description, entityIndex++));
+        if (!description.name.empty())
+            namedRows[description.name] = r;
+        if (!description.parent.empty())
+            attachments.emplace_back(r, description.parent);
+    };
+
+    if (!streamSceneJSON(jsonFile, handlers))
+        std::cerr << "Failed to load scene: " << jsonFile << std::endl;
+
+    for (const auto &attachment : attachments)
     {
-        std::cerr << "Failed to open JSON scene file: " << jsonFile << std::endl;
+        auto found = namedRows.find(attachment.second);
+        if (found == namedRows.end())
+            std::cerr << "Unknown parent entity: " << attachment.second << std::endl;
+        else
+            entityStore.setParent(attachment.first, found->second);
+    }
+}
+
+static uint32_t findEntityRow(const std::string &sceneKey)
+{
+    for (uint32_t r = 0; r < entities.size(); ++r)
+        if (entities[r].getSceneKey() == sceneKey)
+            return r;
+    return EntityStore::NO_PARENT;
+}
+
+static void resolvePendingAttachments()
+{
+    for (size_t i = 0; i < pendingAttachments.size();)
+    {
+        uint32_t child = findEntityRow(pendingAttachments[i].first);
+        uint32_t parent = findEntityRow(pendingAttachments[i].second);
+        if (child != EntityStore::NO_PARENT && parent != EntityStore::NO_PARENT)
+        {
+            entityStore.setParent(child, parent);
+            pendingAttachments[i] = pendingAttachments.back();
+            pendingAttachments.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+// Diffs the edited file against the live entities. Transform edits are
+// patched in place, only the assets whose path changed are reloaded (in the
+// background), new entities stream in and missing ones are released. The
+// camera stays where the user flew it.
+void reloadScene(const std::string &jsonFile)
+{
+    std::vector<SceneEntityDescription> descriptions;
+    std::vector<PointLight> newLights;
+    glm::vec3 newLightPos = lightPos;
+
+    SceneStreamHandlers handlers;
+    handlers.onKeyLight = [&](const glm::vec3 &position)
+    { newLightPos = position; };
+    handlers.onLight = [&](const SceneLightDescription &light)
+    {
+        PointLight pointLight;
+        pointLight.position = light.position;
+        pointLight.radius = light.radius;
+        pointLight.color = light.color;
+        newLights.push_back(pointLight);
+    };
+    handlers.onEntity = [&](const SceneEntityDescription &description)
+    { descriptions.push_back(description); };
+    if (!streamSceneJSON(jsonFile, handlers))
+    {
+        std::cerr << "Scene reload skipped, keeping the current scene" << std::endl;
         return;
     }
 
-    json scene;
-    file >> scene;
+    lightPos = newLightPos;
+    pointLights = newLights;
+    clusteredLighting.setLights(pointLights);
 
-    camera.position = glm::vec3(scene["camera"]["position"][0], scene["camera"]["position"][1], scene["camera"]["position"][2]);
-    camera.front = glm::vec3(scene["camera"]["front"][0], scene["camera"]["front"][1], scene["camera"]["front"][2]);
-    camera.up = glm::vec3(scene["camera"]["up"][0], scene["camera"]["up"][1], scene["camera"]["up"][2]);
-    camera.fov = scene["camera"]["fov"];
+    std::unordered_map<std::string, uint32_t> liveRows;
+    for (uint32_t r = 0; r < entities.size(); ++r)
+        liveRows[entities[r].getSceneKey()] = r;
 
-    lightPos = glm::vec3(scene["light"]["position"][0], scene["light"]["position"][1], scene["light"]["position"][2]);
+    std::vector<bool> keep(entities.size(), false);
+    std::vector<std::string> keys(descriptions.size());
+    std::unordered_set<std::string> incoming;
+    size_t patched = 0, reloaded = 0, added = 0, removed = 0;
+    pendingAttachments.clear();
 
-    for (const auto &obj : scene["entities"])
+    for (size_t i = 0; i < descriptions.size(); ++i)
     {
-        Entity entity(
-            obj["position"][0],
-            obj["position"][1],
-            obj["position"][2],
-            glm::vec3(0.0f, 0.0f, 0.0f),
-            obj["scale"],
-            obj["obj"],
-            obj["mtl"],
-            obj["texture"],
-            glm::vec3(
-                glm::radians(float(obj["rotation"][0])),
-                glm::radians(float(obj["rotation"][1])),
-                glm::radians(float(obj["rotation"][2]))));
+        const SceneEntityDescription &description = descriptions[i];
+        keys[i] = sceneKeyFor(description, i);
+        auto live = liveRows.find(keys[i]);
+        if (live == liveRows.end())
+        {
+            if (!description.parent.empty())
+                pendingAttachments.emplace_back(keys[i], description.parent);
+            incoming.insert(keys[i]);
+
+            // Saved again before the entity arrived: the load in flight still
+            // serves it, with the newest description, unless the .mtl changed.
+            auto pending = pendingSceneAdds.find(keys[i]);
+            if (pending != pendingSceneAdds.end() && pending->second.description.mtl == description.mtl)
+            {
+                pending->second.description = description;
+                continue;
+            }
+
+            uint32_t requestId = nextSceneAddRequest++;
+            pendingSceneAdds[keys[i]] = {requestId, description};
+            EntityAssetRequest request;
+            request.mtlFile = description.mtl;
+            std::string key = keys[i];
+            assetLoader.enqueue(request, [key, requestId](EntityAssetData &data)
+                                {
+                auto pending = pendingSceneAdds.find(key);
+                if (pending == pendingSceneAdds.end() || pending->second.request != requestId)
+                    return;
+                SceneEntityDescription latest = pending->second.description;
+                pendingSceneAdds.erase(pending);
+                createSceneEntity(latest, key).initialize(data);
+                resolvePendingAttachments(); });
+            ++added;
+            continue;
+        }
+
+        uint32_t r = live->second;
+        keep[r] = true;
+        Entity &entity = entities[r];
 
-        if (!obj["trajectory"].get<std::string>().empty())
+        bool moved = (!entity.followsBezier() && entityStore.position[r] != description.position) ||
+                     entityStore.baseRotation[r] != description.rotation || entityStore.scale[r] != description.scale;
+        if (moved)
         {
-            entity.loadBezierControlPoints(obj["trajectory"]);
+            if (!entity.followsBezier())
+                entityStore.position[r] = description.position;
+            entityStore.baseRotation[r] = description.rotation;
+            entityStore.scale[r] = description.scale;
+            entityStore.markDirty(r);
+            ++patched;
         }
-        entity.initialize();
-        entities.push_back(entity);
+
+        // Shared assets are swapped through assetManager: an unchanged path
+        // keeps its reference, a path already used elsewhere is not reloaded.
+        bool sharedChanged = description.obj != entity.getObjFilePath() ||
+                             description.texture != entity.getTextureFilePath() ||
+                             description.trajectory != entity.getTrajectoryFilePath();
+        bool materialChanged = description.mtl != entity.getMtlFilePath();
+        entity.changeAssets(description.obj, description.mtl, description.texture, description.trajectory);
+        entity.setTrajectorySpeed(description.speed);
+
+        if (materialChanged && !description.mtl.empty())
+        {
+            EntityAssetRequest request;
+            request.mtlFile = description.mtl;
+            // Rows move when entities are removed; the handle stays valid.
+            EntityHandle handle = entity.getHandle();
+            assetLoader.enqueue(request, [handle](EntityAssetData &data)
+                                {
+                if (entityStore.isValid(handle))
+                    entities[entityStore.row(handle)].initialize(data); });
+        }
+        if (sharedChanged || materialChanged)
+            ++reloaded;
     }
-}
\ No newline at end of file
+
+    // Adds still loading but no longer in the file are dropped on arrival.
+    for (auto pending = pendingSceneAdds.begin(); pending != pendingSceneAdds.end();)
+    {
+        if (incoming.count(pending->first))
+        {
+            ++pending;
+            continue;
+        }
+        pending = pendingSceneAdds.erase(pending);
+        ++removed;
+    }
+
+    // Descending, so the row swapped into a freed slot is always a kept one.
+    for (uint32_t r = static_cast<uint32_t>(keep.size()); r-- > 0;)
+    {
+        if (!keep[r])
+        {
+            removeEntity(r);
+            ++removed;
+        }
+    }
+
+    for (size_t i = 0; i < descriptions.size(); ++i)
+    {
+        uint32_t child = findEntityRow(keys[i]);
+        if (child == EntityStore::NO_PARENT)
+            continue;
+        uint32_t parent = EntityStore::NO_PARENT;
+        if (!descriptions[i].parent.empty())
+        {
+            parent = findEntityRow(descriptions[i].parent);
+            if (parent == EntityStore::NO_PARENT)
+                pendingAttachments.emplace_back(keys[i], descriptions[i].parent);
+        }
+        if (entityStore.parent[child] != parent)
+            entityStore.setParent(child, parent);
+    }
+
+    sceneStructureChanged = true;
+    std::cout << "Scene reloaded: " << patched << " moved, " << reloaded << " reloading assets, " << added
+              << " added, " << removed << " removed" << std::endl;
+}
+
+// Releases the entity's GL objects and swap-removes it, mirroring the store.
+void removeEntity(uint32_t row)
+{
+    entities[row].release();
+    entityStore.destroy(entities[row].getHandle());
+    occlusionCuller.removeRow(row, static_cast<uint32_t>(entities.size() - 1));
+    if (row != entities.size() - 1)
+        entities[row] = std::move(entities.back());
+    entities.pop_back();
+
+    if (selectedEntityIndex >= static_cast<int>(entities.size()))
+        selectedEntityIndex = 0;
+    sceneStructureChanged = true;
+}
+
+// One simulation tick of every trajectory follower: the batch computes the
+// new states, which are copied into the store behind the previous ones.
+void advanceTrajectories(float tickSeconds)
+{
+    trajectoryBatch.update(tickSeconds);
+    for (uint32_t lane = 0; lane < trajectoryBatch.size(); ++lane)
+    {
+        if (trajectoryBatch.isWaiting(lane))
+            continue;
+        uint32_t r = entityStore.rowOfSlot(trajectoryBatch.key(lane));
+        entityStore.previousPosition[r] = entityStore.position[r];
+        entityStore.position[r] = trajectoryBatch.position(lane);
+        // Paths without rotations leave the entity's own orientation alone.
+        if (trajectoryBatch.rotates(lane))
+        {
+            entityStore.previousRotation[r] = entityStore.rotation[r];
+            entityStore.rotation[r] = trajectoryBatch.rotation(lane);
+        }
+    }
+
+    // No interpolation across a jump back to the path start.
+    for (uint32_t lane : trajectoryBatch.restartedLanes())
+    {
+        uint32_t r = entityStore.rowOfSlot(trajectoryBatch.key(lane));
+        entityStore.previousPosition[r] = entityStore.position[r];
+        entityStore.previousRotation[r] = entityStore.rotation[r];
+    }
+
+    // Backwards, since a failed lane is swap-removed with the last one.
+    if (trajectoryBatch.waitingCount() > 0)
+        for (uint32_t lane = static_cast<uint32_t>(trajectoryBatch.size()); lane-- > 0;)
+            if (trajectoryBatch.isWaiting(lane))
+                entities[entityStore.rowOfSlot(trajectoryBatch.key(lane))].trajectoryFailed();
+}
+
+void sortFrontToBack(std::vector<uint32_t> &indices, const glm::vec3 &cameraPosition)
+{
+    using Key = std::pair<float, uint32_t>;
+    Key *keyed = frameArena.current().allocateArray<Key>(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        glm::vec3 d = entities[indices[i]].getWorldBoundingSphere().center - cameraPosition;
+        new (&keyed[i]) Key(glm::dot(d, d), indices[i]);
+    }
+
+    std::sort(keyed, keyed + indices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+        indices[i] = keyed[i].second;
+}
+
+void rebuildSceneBVH()
+{
+    std::vector<AABB> bounds;
+    bounds.reserve(entities.size());
+    for (const Entity &entity : entities)
+        bounds.push_back(entity.getWorldAABB());
+    sceneBVH.build(bounds);
+}
+
+// Called at the start of each frame, so the previous frame's statistics are complete.
+void recordBenchmarkFrame(GLFWwindow *window)
+{
+    double now = glfwGetTime();
+    if (benchmark.frameIndex++ > BENCHMARK_WARMUP_FRAMES)
+    {
+        double frameMs = (now - benchmark.lastFrameTime) * 1000.0;
+        benchmark.frameMsSum += frameMs;
+        benchmark.frameMsMax = std::max(benchmark.frameMsMax, frameMs);
+        benchmark.drawCallSum += glState.lastFrameStats().drawCalls;
+        benchmark.allocationSum += lastFrameAllocations;
+        if (lastSceneGpuMs >= 0.0)
+        {
+            benchmark.gpuMsSum += lastSceneGpuMs;
+            ++benchmark.gpuSamples;
+        }
+    }
+    benchmark.lastFrameTime = now;
+
+    int measured = benchmark.frameIndex - BENCHMARK_WARMUP_FRAMES - 1;
+    if (measured < benchmark.frames)
+        return;
+
+    double frameMs = benchmark.frameMsSum / measured;
+    double gpuMs = benchmark.gpuSamples ? benchmark.gpuMsSum / benchmark.gpuSamples : -1.0;
+    double drawCalls = benchmark.drawCallSum / measured;
+    std::cout << "Benchmark: " << entities.size() << " entities, load " << benchmark.loadMs << " ms, frame "
+              << frameMs << " ms (max " << benchmark.frameMsMax << "), GPU scene " << gpuMs << " ms, "
+              << drawCalls << " draw calls, " << benchmark.allocationSum / measured << " heap allocations/frame"
+              << std::endl;
+
+    std::ofstream csv(benchmark.csvFile, std::ios::app);
+    csv << entities.size() << "," << benchmark.loadMs << "," << frameMs << "," << benchmark.frameMsMax << "," << gpuMs
+        << "," << drawCalls << "\n";
+    glfwSetWindowShouldClose(window, true);
+}
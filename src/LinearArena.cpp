@@ -0,0 +1,97 @@
+#include "LinearArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+FrameArena frameArena;
+
+LinearArena::LinearArena(size_t initialCapacity)
+{
+    if (initialCapacity > 0)
+        blocks.push_back({new unsigned char[initialCapacity], initialCapacity});
+}
+
+LinearArena::~LinearArena()
+{
+    for (Block &block : blocks)
+        delete[] block.data;
+}
+
+void *LinearArena::allocate(size_t bytes, size_t alignment)
+{
+    if (bytes == 0)
+        bytes = 1;
+    for (;;)
+    {
+        if (currentBlock < blocks.size())
+        {
+            Block &block = blocks[currentBlock];
+            uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            size_t aligned = ((base + cursor + alignment - 1) & ~(uintptr_t(alignment) - 1)) - base;
+            if (aligned + bytes <= block.size)
+            {
+                usedBytes += aligned + bytes - cursor;
+                highWater = std::max(highWater, usedBytes);
+                cursor = aligned + bytes;
+                return block.data + aligned;
+            }
+            if (currentBlock + 1 < blocks.size())
+            {
+                ++currentBlock;
+                cursor = 0;
+                continue;
+            }
+        }
+
+        // Out of room: chain a block at least as large as everything so far.
+        size_t size = std::max(bytes + alignment, capacity());
+        blocks.push_back({new unsigned char[size], size});
+        currentBlock = blocks.size() - 1;
+        cursor = 0;
+        if (blocks.size() > 1)
+            ++overflows;
+    }
+}
+
+void LinearArena::reset()
+{
+    if (blocks.size() > 1)
+    {
+        // Coalesce, so the next cycle of the same size fits in one block.
+        size_t size = std::max(highWater, capacity());
+        for (Block &block : blocks)
+            delete[] block.data;
+        blocks.clear();
+        blocks.push_back({new unsigned char[size], size});
+    }
+    currentBlock = 0;
+    cursor = 0;
+    usedBytes = 0;
+}
+
+size_t LinearArena::capacity() const
+{
+    size_t total = 0;
+    for (const Block &block : blocks)
+        total += block.size;
+    return total;
+}
+
+FrameArena::FrameArena(size_t initialCapacity) : arenas{LinearArena(initialCapacity), LinearArena(initialCapacity)}
+{
+}
+
+void FrameArena::beginFrame()
+{
+    index ^= 1;
+    arenas[index].reset();
+}
+
+void FrameArena::printStats() const
+{
+    const LinearArena &arena = arenas[index ^ 1]; // the last complete frame
+    std::cout << "Frame arena: " << arena.used() / 1024.0 << " KB last frame, high-water "
+              << std::max(arenas[0].highWaterMark(), arenas[1].highWaterMark()) / 1024.0 << " KB of "
+              << arena.capacity() / 1024.0 << " KB, " << arenas[0].overflowCount() + arenas[1].overflowCount()
+              << " overflow blocks" << std::endl;
+}
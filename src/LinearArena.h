@@ -0,0 +1,99 @@
+#ifndef LINEAR_ARENA_H
+#define LINEAR_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Bump allocator: an allocation is a pointer increment into a block, and
+// everything is freed at once by reset(). When a cycle outgrows the block,
+// extra blocks are chained; the next reset() replaces them with a single
+// block as large as the high-water mark, so a steady workload settles into
+// zero heap allocations. Destructors are never run: only trivially
+// destructible data (or containers whose elements are) belongs here.
+class LinearArena
+{
+public:
+    explicit LinearArena(size_t initialCapacity = 64 * 1024);
+    ~LinearArena();
+    LinearArena(const LinearArena &) = delete;
+    LinearArena &operator=(const LinearArena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T *allocateArray(size_t count)
+    {
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset();
+
+    size_t used() const { return usedBytes; }
+    size_t capacity() const;
+    size_t highWaterMark() const { return highWater; }
+    // Extra blocks allocated because a cycle outgrew the arena.
+    size_t overflowCount() const { return overflows; }
+
+private:
+    struct Block
+    {
+        unsigned char *data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks; // blocks[0] survives reset()
+    size_t currentBlock = 0;
+    size_t cursor = 0;
+    size_t usedBytes = 0;
+    size_t highWater = 0;
+    size_t overflows = 0;
+};
+
+// Lets standard containers draw from an arena; deallocate is a no-op, the
+// memory comes back with the arena's reset().
+template <typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    LinearArena *arena;
+
+    ArenaAllocator(LinearArena &owner) : arena(&owner) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t count) { return arena->allocateArray<T>(count); }
+    void deallocate(T *, size_t) {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Per-frame scratch memory (sort keys, transient lists). Two arenas
+// alternate, so what frame N allocated stays valid through frame N + 1 for
+// consumers that lag a frame behind.
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t initialCapacity = 1024 * 1024);
+
+    // Resets the arena the frame before last used and makes it current.
+    void beginFrame();
+    LinearArena &current() { return arenas[index]; }
+    LinearArena &previous() { return arenas[index ^ 1]; }
+
+    void printStats() const;
+
+private:
+    LinearArena arenas[2];
+    int index = 0;
+};
+
+extern FrameArena frameArena;
+
+#endif
@@ -0,0 +1,219 @@
+#include "OcclusionCuller.h"
+#include "Entity.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include "StreamRingBuffer.h"
+#include <iostream>
+
+static const GLchar *boxVertexSource = R"glsl(
+    #version 410 core
+    layout(location = 0) in vec3 position;
+
+    layout(std140) uniform FrameData {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 camPos;
+    };
+    uniform vec3 boxCenter;
+    uniform vec3 boxExtent;
+
+    void main() {
+        gl_Position = projection * view * vec4(boxCenter + position * boxExtent, 1.0);
+    }
+)glsl";
+
+static const GLchar *boxFragmentSource = R"glsl(
+    #version 410 core
+    out vec4 FragColor;
+    void main() {
+        FragColor = vec4(1.0);
+    }
+)glsl";
+
+// Near plane distance used by Hello3D; a box closer than this to the camera
+// may be clipped away even though the camera is inside it.
+static constexpr float NEAR_MARGIN = 0.1f;
+
+void OcclusionCuller::initialize()
+{
+    queryTarget = glExt.conservativeOcclusion ? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+
+    boxProgram = buildShaderProgram(boxVertexSource, boxFragmentSource);
+    bindUniformBlock(boxProgram, "FrameData", Entity::FRAME_UNIFORM_BINDING);
+    boxCenterLocation = glGetUniformLocation(boxProgram, "boxCenter");
+    boxExtentLocation = glGetUniformLocation(boxProgram, "boxExtent");
+
+    const GLfloat cube[] = {
+        -1, -1, -1, 1, -1, -1, 1, 1, -1, 1, 1, -1, -1, 1, -1, -1, -1, -1,
+        -1, -1, 1, 1, -1, 1, 1, 1, 1, 1, 1, 1, -1, 1, 1, -1, -1, 1,
+        -1, 1, 1, -1, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, -1, 1, 1,
+        1, 1, 1, 1, 1, -1, 1, -1, -1, 1, -1, -1, 1, -1, 1, 1, 1, 1,
+        -1, -1, -1, 1, -1, -1, 1, -1, 1, 1, -1, 1, -1, -1, 1, -1, -1, -1,
+        -1, 1, -1, 1, 1, -1, 1, 1, 1, 1, 1, 1, -1, 1, 1, -1, 1, -1};
+
+    glGenVertexArrays(1, &boxVAO);
+    glGenBuffers(1, &boxVBO);
+    glState.bindVertexArray(boxVAO);
+    glState.bindBuffer(GL_ARRAY_BUFFER, boxVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cube), cube, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (void *)0);
+    glEnableVertexAttribArray(0);
+    glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+    glState.bindVertexArray(0);
+}
+
+void OcclusionCuller::release()
+{
+    for (ObjectState &state : states)
+        if (state.query)
+            glDeleteQueries(1, &state.query);
+    states.clear();
+
+    if (boxVAO)
+        glState.deleteVertexArray(boxVAO);
+    if (boxVBO)
+        glState.deleteBuffer(boxVBO);
+    if (boxProgram)
+        glState.deleteProgram(boxProgram);
+    boxVAO = boxVBO = boxProgram = 0;
+}
+
+void OcclusionCuller::removeRow(uint32_t row, uint32_t lastRow)
+{
+    if (row >= states.size())
+        return;
+    if (states[row].query)
+        glDeleteQueries(1, &states[row].query);
+
+    if (lastRow >= states.size())
+    {
+        states[row] = ObjectState(); // the moved entity was never seen here
+        return;
+    }
+    states[row] = states[lastRow];
+    states[lastRow] = ObjectState();
+    if (lastRow == states.size() - 1)
+        states.pop_back();
+}
+
+GLuint OcclusionCuller::queryFor(ObjectState &state)
+{
+    if (!state.query)
+        glGenQueries(1, &state.query);
+    state.pending = true;
+    return state.query;
+}
+
+void OcclusionCuller::collectResults()
+{
+    occludedResults = 0;
+    for (ObjectState &state : states)
+    {
+        if (!state.pending)
+            continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(state.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint samplesPassed = 0;
+            glGetQueryObjectuiv(state.query, GL_QUERY_RESULT, &samplesPassed);
+            state.visible = samplesPassed != 0;
+            if (!state.visible)
+                occludedResults++;
+        }
+        else
+        {
+            // Not back yet: stay conservative rather than stall.
+            state.visible = true;
+        }
+        state.pending = false;
+    }
+}
+
+void OcclusionCuller::render(std::vector<Entity> &entities, const std::vector<uint32_t> &candidates,
+                             StreamRingBuffer &uniformRing, const glm::vec3 &cameraPosition)
+{
+    for (size_t i = entities.size(); i < states.size(); ++i)
+        if (states[i].query)
+            glDeleteQueries(1, &states[i].query);
+    if (states.size() != entities.size())
+        states.resize(entities.size());
+
+    collectResults();
+
+    for (ObjectState &state : states)
+        state.candidate = false;
+    for (uint32_t index : candidates)
+        states[index].candidate = true;
+    for (ObjectState &state : states)
+        if (!state.candidate)
+            state.visible = false;
+
+    drawnDirect = 0;
+    testList.clear();
+
+    // Pass 1: last frame's visible set (and anything the camera is inside of).
+    for (uint32_t index : candidates)
+    {
+        ObjectState &state = states[index];
+        AABB box = entities[index].getWorldAABB();
+        box.min -= glm::vec3(NEAR_MARGIN);
+        box.max += glm::vec3(NEAR_MARGIN);
+        bool cameraInside = glm::all(glm::greaterThanEqual(cameraPosition, box.min)) &&
+                            glm::all(glm::lessThanEqual(cameraPosition, box.max));
+
+        if (!state.visible && !cameraInside)
+        {
+            testList.push_back(index);
+            continue;
+        }
+
+        glBeginQuery(queryTarget, queryFor(state));
+        entities[index].draw(uniformRing);
+        glEndQuery(queryTarget);
+        drawnDirect++;
+    }
+
+    tested = static_cast<unsigned int>(testList.size());
+    if (testList.empty())
+        return;
+
+    // Pass 2a: bounding boxes against the depth laid down by pass 1.
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    glState.useProgram(boxProgram);
+    glState.bindVertexArray(boxVAO);
+    for (uint32_t index : testList)
+    {
+        AABB box = entities[index].getWorldAABB();
+        glm::vec3 center = box.center();
+        glm::vec3 extent = box.extents();
+        glUniform3f(boxCenterLocation, center.x, center.y, center.z);
+        glUniform3f(boxExtentLocation, extent.x, extent.y, extent.z);
+
+        glBeginQuery(queryTarget, queryFor(states[index]));
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+        glState.countDrawCall();
+        glEndQuery(queryTarget);
+    }
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+
+    // Pass 2b: the GPU drops each draw whose box query saw no samples.
+    for (uint32_t index : testList)
+    {
+        glBeginConditionalRender(states[index].query, GL_QUERY_WAIT);
+        entities[index].draw(uniformRing);
+        glEndConditionalRender();
+    }
+}
+
+void OcclusionCuller::printStats() const
+{
+    std::cout << "Occlusion culling: " << drawnDirect << " drawn directly, " << tested
+              << " tested by bounding box, " << occludedResults << " occluded (last results)"
+              << (queryTarget == GL_ANY_SAMPLES_PASSED_CONSERVATIVE ? " [conservative]" : "") << std::endl;
+}
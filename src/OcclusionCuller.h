@@ -0,0 +1,61 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Entity;
+class StreamRingBuffer;
+
+// Two-pass hardware occlusion culling that never waits on the CPU:
+//  1. entities that were visible last frame are drawn normally (each inside a
+//     query) and lay down the depth buffer;
+//  2. the remaining candidates rasterize their world AABB against that depth
+//     with writes disabled, and the real draw is issued under
+//     glBeginConditionalRender so the GPU discards it when no sample passed.
+// Query results are only read back once available, one frame later, to decide
+// which pass an entity goes into.
+class OcclusionCuller
+{
+public:
+    void initialize();
+    void release();
+
+    void render(std::vector<Entity> &entities, const std::vector<uint32_t> &candidates,
+                StreamRingBuffer &uniformRing, const glm::vec3 &cameraPosition);
+    // Mirrors the swap-remove of entity row (lastRow moves into it), so the
+    // moved entity keeps its own query and the removed one's is deleted.
+    void removeRow(uint32_t row, uint32_t lastRow);
+
+    void printStats() const;
+
+private:
+    struct ObjectState
+    {
+        GLuint query = 0;
+        bool visible = false;
+        bool pending = false;
+        bool candidate = false;
+    };
+
+    std::vector<ObjectState> states;
+    std::vector<uint32_t> testList;
+
+    GLenum queryTarget = GL_ANY_SAMPLES_PASSED;
+    GLuint boxProgram = 0;
+    GLuint boxVAO = 0;
+    GLuint boxVBO = 0;
+    GLint boxCenterLocation = -1;
+    GLint boxExtentLocation = -1;
+
+    unsigned int drawnDirect = 0;
+    unsigned int tested = 0;
+    unsigned int occludedResults = 0;
+
+    void collectResults();
+    GLuint queryFor(ObjectState &state);
+};
+
+#endif
@@ -0,0 +1,380 @@
+#include "SceneBVH.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// Objects without usable bounds (a mesh that failed to load, or a transform
+// that produced NaN) are kept as empty boxes, which no query ever reports.
+static AABB usableBounds(const AABB &box)
+{
+    bool finite = std::isfinite(box.min.x) && std::isfinite(box.min.y) && std::isfinite(box.min.z) &&
+                  std::isfinite(box.max.x) && std::isfinite(box.max.y) && std::isfinite(box.max.z);
+    return finite && box.isValid() ? box : AABB();
+}
+
+// Bin of a centroid, clamped: empty boxes have their centroid outside the range.
+static int binIndex(float centroid, float minC, float extent, int bins)
+{
+    float bin = (centroid - minC) / extent * bins;
+    if (!(bin >= 0.0f))
+        return 0;
+    return std::min(bins - 1, static_cast<int>(std::min(bin, float(bins))));
+}
+
+void SceneBVH::build(const std::vector<AABB> &objectBounds)
+{
+    if (&objectBounds != &bounds)
+        bounds = objectBounds;
+    for (AABB &box : bounds)
+        box = usableBounds(box);
+
+    uint32_t count = static_cast<uint32_t>(bounds.size());
+    nodes.clear();
+    objectOrder.resize(count);
+    std::iota(objectOrder.begin(), objectOrder.end(), 0u);
+    objectLeaf.assign(count, -1);
+    totalCost = 0.0;
+    buildCost = 0.0;
+    rebuilds++;
+
+    if (count == 0)
+        return;
+
+    nodes.reserve(2 * count);
+    buildRecursive(0, count, -1, 0);
+
+    float rootArea = nodes[0].box.surfaceArea();
+    buildCost = rootArea > 0.0f ? totalCost / rootArea : 0.0;
+}
+
+double SceneBVH::nodeCost(const Node &node) const
+{
+    double weight = node.isLeaf() ? node.count * INTERSECTION_COST : TRAVERSAL_COST;
+    return node.box.surfaceArea() * weight;
+}
+
+int32_t SceneBVH::buildRecursive(uint32_t first, uint32_t count, int32_t parent, int depth)
+{
+    int32_t index = static_cast<int32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].parent = parent;
+
+    AABB box, centroids;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        const AABB &b = bounds[objectOrder[i]];
+        box.expand(b);
+        if (b.isValid())
+            centroids.expand(b.center());
+    }
+    nodes[index].box = box;
+
+    if (count <= MAX_LEAF_OBJECTS)
+    {
+        nodes[index].first = first;
+        nodes[index].count = count;
+        for (uint32_t i = first; i < first + count; ++i)
+            objectLeaf[objectOrder[i]] = index;
+        totalCost += nodeCost(nodes[index]);
+        return index;
+    }
+
+    // Binned SAH over the centroid extent of each axis.
+    int bestAxis = -1;
+    int bestSplit = 0;
+    float bestCost = FLT_MAX;
+    if (depth < MAX_SAH_DEPTH)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float minC = centroids.min[axis];
+            float extent = centroids.max[axis] - minC;
+            if (extent <= 0.0f)
+                continue;
+
+            AABB binBox[SAH_BINS];
+            uint32_t binCount[SAH_BINS] = {};
+            for (uint32_t i = first; i < first + count; ++i)
+            {
+                const AABB &b = bounds[objectOrder[i]];
+                int bin = binIndex(b.center()[axis], minC, extent, SAH_BINS);
+                binBox[bin].expand(b);
+                binCount[bin]++;
+            }
+
+            float leftArea[SAH_BINS - 1];
+            uint32_t leftCount[SAH_BINS - 1];
+            AABB acc;
+            uint32_t n = 0;
+            for (int i = 0; i < SAH_BINS - 1; ++i)
+            {
+                if (binCount[i])
+                    acc.expand(binBox[i]);
+                n += binCount[i];
+                leftArea[i] = n ? acc.surfaceArea() : 0.0f;
+                leftCount[i] = n;
+            }
+
+            acc = AABB();
+            n = 0;
+            for (int i = SAH_BINS - 1; i > 0; --i)
+            {
+                if (binCount[i])
+                    acc.expand(binBox[i]);
+                n += binCount[i];
+                if (n == 0 || leftCount[i - 1] == 0)
+                    continue;
+                float cost = leftArea[i - 1] * leftCount[i - 1] + acc.surfaceArea() * n;
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = i;
+                }
+            }
+        }
+    }
+
+    uint32_t *begin = objectOrder.data() + first;
+    uint32_t *end = begin + count;
+    uint32_t *middle = begin;
+    if (bestAxis >= 0)
+    {
+        float minC = centroids.min[bestAxis];
+        float extent = centroids.max[bestAxis] - minC;
+        middle = std::partition(begin, end, [&](uint32_t object)
+                                {
+                                    return binIndex(bounds[object].center()[bestAxis], minC, extent, SAH_BINS) < bestSplit; });
+    }
+    if (middle == begin || middle == end)
+    {
+        // No usable SAH split: median along the widest centroid axis.
+        glm::vec3 extent = centroids.isValid() ? centroids.max - centroids.min : glm::vec3(0.0f);
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        middle = begin + count / 2;
+        std::nth_element(begin, middle, end, [&](uint32_t a, uint32_t b)
+                         { return bounds[a].center()[axis] < bounds[b].center()[axis]; });
+    }
+
+    uint32_t leftCount = static_cast<uint32_t>(middle - begin);
+    int32_t left = buildRecursive(first, leftCount, index, depth + 1);
+    int32_t right = buildRecursive(first + leftCount, count - leftCount, index, depth + 1);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    totalCost += nodeCost(nodes[index]);
+    return index;
+}
+
+void SceneBVH::updateObject(uint32_t object, const AABB &newBounds)
+{
+    if (object >= bounds.size())
+        return;
+    bounds[object] = usableBounds(newBounds);
+
+    int32_t index = objectLeaf[object];
+    while (index != -1)
+    {
+        Node &node = nodes[index];
+        AABB box;
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                box.expand(bounds[objectOrder[i]]);
+        }
+        else
+        {
+            box = nodes[node.left].box;
+            box.expand(nodes[node.right].box);
+        }
+
+        // Ancestors only depend on this box, so stop as soon as it is unchanged.
+        if (box.min == node.box.min && box.max == node.box.max)
+            break;
+
+        totalCost -= nodeCost(node);
+        node.box = box;
+        totalCost += nodeCost(node);
+        index = node.parent;
+    }
+}
+
+float SceneBVH::costRatio() const
+{
+    if (nodes.empty() || buildCost <= 0.0)
+        return 1.0f;
+    float rootArea = nodes[0].box.surfaceArea();
+    if (rootArea <= 0.0f)
+        return 1.0f;
+    return static_cast<float>((totalCost / rootArea) / buildCost);
+}
+
+bool SceneBVH::rebuildIfDegraded()
+{
+    if (costRatio() <= REBUILD_RATIO)
+        return false;
+    build(bounds);
+    return true;
+}
+
+void SceneBVH::collectLeaves(int32_t nodeIndex, std::vector<uint32_t> &out) const
+{
+    int32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = nodeIndex;
+    while (top > 0)
+    {
+        const Node &node = nodes[stack[--top]];
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                if (bounds[objectOrder[i]].isValid())
+                    out.push_back(objectOrder[i]);
+            continue;
+        }
+        stack[top++] = node.left;
+        stack[top++] = node.right;
+    }
+}
+
+void SceneBVH::queryFrustum(const Frustum &frustum, std::vector<uint32_t> &out) const
+{
+    if (nodes.empty())
+        return;
+
+    int32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int32_t index = stack[--top];
+        const Node &node = nodes[index];
+        Frustum::Containment containment = frustum.classifyAABB(node.box);
+        if (containment == Frustum::OUTSIDE)
+            continue;
+        if (containment == Frustum::INSIDE)
+        {
+            collectLeaves(index, out);
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                if (frustum.intersectsAABB(bounds[objectOrder[i]]))
+                    out.push_back(objectOrder[i]);
+            continue;
+        }
+        stack[top++] = node.left;
+        stack[top++] = node.right;
+    }
+}
+
+static float distanceSquared(const AABB &box, const glm::vec3 &p)
+{
+    glm::vec3 d = glm::max(glm::max(box.min - p, p - box.max), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+void SceneBVH::querySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &out) const
+{
+    if (nodes.empty())
+        return;
+
+    float radiusSquared = radius * radius;
+    int32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = nodes[stack[--top]];
+        if (distanceSquared(node.box, center) > radiusSquared)
+            continue;
+
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+                if (distanceSquared(bounds[objectOrder[i]], center) <= radiusSquared)
+                    out.push_back(objectOrder[i]);
+            continue;
+        }
+        stack[top++] = node.left;
+        stack[top++] = node.right;
+    }
+}
+
+// Slab test; returns the entry distance or -1 when the ray misses within maxT.
+static float intersectRay(const AABB &box, const glm::vec3 &origin, const glm::vec3 &invDir, float maxT)
+{
+    if (!box.isValid())
+        return -1.0f;
+    float tMin = 0.0f, tMax = maxT;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float t0 = (box.min[axis] - origin[axis]) * invDir[axis];
+        float t1 = (box.max[axis] - origin[axis]) * invDir[axis];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax)
+            return -1.0f;
+    }
+    return tMin;
+}
+
+bool SceneBVH::raycast(const glm::vec3 &origin, const glm::vec3 &direction, uint32_t &hitObject, float &hitT) const
+{
+    if (nodes.empty())
+        return false;
+
+    glm::vec3 invDir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    float closest = FLT_MAX;
+    bool hit = false;
+
+    int32_t stack[STACK_SIZE];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = nodes[stack[--top]];
+        if (intersectRay(node.box, origin, invDir, closest) < 0.0f)
+            continue;
+
+        if (node.isLeaf())
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i)
+            {
+                float t = intersectRay(bounds[objectOrder[i]], origin, invDir, closest);
+                if (t >= 0.0f && t < closest)
+                {
+                    closest = t;
+                    hitObject = objectOrder[i];
+                    hit = true;
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first so the farther one is pruned more often.
+        float tLeft = intersectRay(nodes[node.left].box, origin, invDir, closest);
+        float tRight = intersectRay(nodes[node.right].box, origin, invDir, closest);
+        if (tLeft >= 0.0f && tRight >= 0.0f)
+        {
+            bool leftFirst = tLeft <= tRight;
+            stack[top++] = leftFirst ? node.right : node.left;
+            stack[top++] = leftFirst ? node.left : node.right;
+        }
+        else if (tLeft >= 0.0f)
+        {
+            stack[top++] = node.left;
+        }
+        else if (tRight >= 0.0f)
+        {
+            stack[top++] = node.right;
+        }
+    }
+
+    if (hit)
+        hitT = closest;
+    return hit;
+}
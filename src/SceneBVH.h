@@ -0,0 +1,69 @@
+#ifndef SCENE_BVH_H
+#define SCENE_BVH_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Bounds.h"
+
+// Bounding volume hierarchy over entity world AABBs.
+// Built top-down with binned SAH; objects that move are refit in place along
+// their leaf-to-root path, and the tree is rebuilt only once the SAH cost has
+// degraded past REBUILD_RATIO relative to the last build.
+class SceneBVH
+{
+public:
+    void build(const std::vector<AABB> &objectBounds);
+
+    // Refits the path of one object; call rebuildIfDegraded() once per frame after the updates.
+    void updateObject(uint32_t object, const AABB &bounds);
+    bool rebuildIfDegraded();
+
+    size_t objectCount() const { return bounds.size(); }
+    float costRatio() const;
+
+    void queryFrustum(const Frustum &frustum, std::vector<uint32_t> &out) const;
+    void querySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &out) const;
+    // Closest object whose AABB the ray hits; direction need not be normalized.
+    bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, uint32_t &hitObject, float &hitT) const;
+
+    unsigned int rebuildCount() const { return rebuilds; }
+
+private:
+    struct Node
+    {
+        AABB box;
+        int32_t parent = -1;
+        int32_t left = -1;
+        int32_t right = -1;
+        uint32_t first = 0; // leaf: range in objectOrder
+        uint32_t count = 0;
+
+        bool isLeaf() const { return count > 0; }
+    };
+
+    static constexpr uint32_t MAX_LEAF_OBJECTS = 4;
+    static constexpr int SAH_BINS = 12;
+    static constexpr float TRAVERSAL_COST = 1.0f;
+    static constexpr float INTERSECTION_COST = 1.0f;
+    static constexpr float REBUILD_RATIO = 1.5f;
+    // Past this depth splits fall back to the median, which bounds the
+    // traversal stack of the queries.
+    static constexpr int MAX_SAH_DEPTH = 48;
+    static constexpr int STACK_SIZE = 128;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> objectOrder;
+    std::vector<int32_t> objectLeaf;
+    std::vector<AABB> bounds;
+
+    double buildCost = 0.0; // normalized SAH cost right after the last build
+    double totalCost = 0.0; // un-normalized sum of node area * node weight
+    unsigned int rebuilds = 0;
+
+    int32_t buildRecursive(uint32_t first, uint32_t count, int32_t parent, int depth);
+    double nodeCost(const Node &node) const;
+    void collectLeaves(int32_t nodeIndex, std::vector<uint32_t> &out) const;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#include <iostream>
+#include <string>
+#include "SceneFile.h"
+
+// Compila um scene.json para o formato binário carregado via mmap pelo Hello3D.
+// Uso: SceneCompiler entrada.json saida.scene
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: SceneCompiler <scene.json> <output.scene>" << std::endl;
+        return 1;
+    }
+
+    if (!compileScene(argv[1], argv[2]))
+        return 1;
+    std::cout << "Compiled " << argv[1] << " -> " << argv[2] << std::endl;
+    return 0;
+}
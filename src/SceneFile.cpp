@@ -0,0 +1,255 @@
+#include "SceneFile.h"
+#include "SceneStream.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool hostIsLittleEndian()
+{
+    const uint16_t probe = 1;
+    uint8_t firstByte;
+    std::memcpy(&firstByte, &probe, 1);
+    return firstByte == 1;
+}
+
+bool SceneFile::open(const std::string &path)
+{
+    close();
+    if (!hostIsLittleEndian())
+    {
+        std::cerr << "Compiled scenes are little-endian only: " << path << std::endl;
+        return false;
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "Failed to open scene file: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    fileHandle = file;
+    mappingHandle = mapping;
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Failed to open scene file: " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    fstat(fd, &info);
+    size = static_cast<size_t>(info.st_size);
+    void *view = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (view == MAP_FAILED)
+        view = nullptr;
+    else
+        madvise(view, size, MADV_SEQUENTIAL);
+#endif
+    data = static_cast<const uint8_t *>(view);
+    if (!data)
+    {
+        std::cerr << "Failed to map scene file: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    const SceneFileHeader &h = header();
+    bool valid = size >= sizeof(SceneFileHeader) && h.magic == SCENE_FILE_MAGIC && h.version == SCENE_FILE_VERSION &&
+                 h.entityOffset + uint64_t(h.entityCount) * sizeof(SceneEntityRecord) <= size &&
+                 h.lightOffset + uint64_t(h.lightCount) * sizeof(SceneLightRecord) <= size &&
+                 h.stringTableOffset + uint64_t(h.stringTableSize) <= size &&
+                 (h.stringTableSize == 0 || data[h.stringTableOffset + h.stringTableSize - 1] == '\0');
+    if (!valid)
+    {
+        std::cerr << "Invalid or outdated scene file (expected version " << SCENE_FILE_VERSION << "): " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SceneFile::close()
+{
+#ifdef _WIN32
+    if (data)
+        UnmapViewOfFile(data);
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+    if (fileHandle)
+        CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (data)
+        munmap(const_cast<uint8_t *>(data), size);
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+const char *SceneFile::string(uint32_t offset) const
+{
+    if (offset == SCENE_NO_STRING || offset >= header().stringTableSize)
+        return "";
+    return reinterpret_cast<const char *>(data + header().stringTableOffset + offset);
+}
+
+// Deduplicating string table builder.
+class StringTable
+{
+public:
+    uint32_t add(const std::string &text)
+    {
+        if (text.empty())
+            return SCENE_NO_STRING;
+        auto found = offsets.find(text);
+        if (found != offsets.end())
+            return found->second;
+        uint32_t offset = static_cast<uint32_t>(bytes.size());
+        bytes.insert(bytes.end(), text.begin(), text.end());
+        bytes.push_back('\0');
+        offsets.emplace(text, offset);
+        return offset;
+    }
+
+    const std::vector<char> &data() const { return bytes; }
+
+private:
+    std::vector<char> bytes;
+    std::unordered_map<std::string, uint32_t> offsets;
+};
+
+static void copyVec3(const glm::vec3 &value, float *out)
+{
+    for (int i = 0; i < 3; ++i)
+        out[i] = value[i];
+}
+
+bool compileScene(const std::string &jsonFile, const std::string &sceneFile)
+{
+    if (!hostIsLittleEndian())
+    {
+        std::cerr << "Compiled scenes are little-endian only" << std::endl;
+        return false;
+    }
+
+    SceneFileHeader header = {};
+    header.magic = SCENE_FILE_MAGIC;
+    header.version = SCENE_FILE_VERSION;
+    // Objects missing from the JSON keep the defaults the JSON loader uses.
+    SceneCameraDescription defaultCamera;
+    copyVec3(defaultCamera.position, header.cameraPosition);
+    copyVec3(defaultCamera.front, header.cameraFront);
+    copyVec3(defaultCamera.up, header.cameraUp);
+    header.cameraFov = defaultCamera.fov;
+    copyVec3(SCENE_DEFAULT_KEY_LIGHT, header.keyLightPosition);
+
+    StringTable strings;
+    std::vector<SceneLightRecord> lights;
+    std::vector<SceneEntityRecord> entities;
+    std::unordered_map<std::string, uint32_t> namedIndices;
+    std::vector<std::string> parentNames;
+
+    SceneStreamHandlers handlers;
+    handlers.onCamera = [&](const SceneCameraDescription &camera)
+    {
+        copyVec3(camera.position, header.cameraPosition);
+        copyVec3(camera.front, header.cameraFront);
+        copyVec3(camera.up, header.cameraUp);
+        header.cameraFov = camera.fov;
+    };
+    handlers.onKeyLight = [&](const glm::vec3 &position)
+    { copyVec3(position, header.keyLightPosition); };
+    bool partitioned = false;
+    handlers.onPartition = [&](const ScenePartitionDescription &)
+    { partitioned = true; };
+    handlers.onLight = [&](const SceneLightDescription &light)
+    {
+        SceneLightRecord record = {};
+        copyVec3(light.position, record.position);
+        record.radius = light.radius;
+        copyVec3(light.color, record.color);
+        lights.push_back(record);
+    };
+    handlers.onEntity = [&](const SceneEntityDescription &entity)
+    {
+        SceneEntityRecord record = {};
+        copyVec3(entity.position, record.position);
+        copyVec3(entity.rotation, record.rotation);
+        record.scale = entity.scale;
+        record.rotateAxis = static_cast<uint32_t>(entity.rotateAxis);
+        record.speed = entity.speed;
+        record.parent = SCENE_NO_PARENT;
+        record.name = strings.add(entity.name);
+        record.obj = strings.add(entity.obj);
+        record.mtl = strings.add(entity.mtl);
+        record.texture = strings.add(entity.texture);
+        record.trajectory = strings.add(entity.trajectory);
+
+        if (!entity.name.empty())
+            namedIndices[entity.name] = static_cast<uint32_t>(entities.size());
+        parentNames.push_back(entity.parent);
+        entities.push_back(record);
+    };
+    if (!streamSceneJSON(jsonFile, handlers))
+        return false;
+    // The binary format has no partition settings; compiling would silently
+    // turn a streamed world into one loaded up front.
+    if (partitioned)
+    {
+        std::cerr << "Partitioned scenes cannot be compiled; load " << jsonFile << " directly" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        if (parentNames[i].empty())
+            continue;
+        auto found = namedIndices.find(parentNames[i]);
+        if (found == namedIndices.end())
+            std::cerr << "Unknown parent entity: " << parentNames[i] << std::endl;
+        else
+            entities[i].parent = found->second;
+    }
+
+    header.entityCount = static_cast<uint32_t>(entities.size());
+    header.entityOffset = sizeof(SceneFileHeader);
+    header.lightCount = static_cast<uint32_t>(lights.size());
+    header.lightOffset = header.entityOffset + header.entityCount * sizeof(SceneEntityRecord);
+    header.stringTableSize = static_cast<uint32_t>(strings.data().size());
+    header.stringTableOffset = header.lightOffset + header.lightCount * sizeof(SceneLightRecord);
+
+    std::ofstream output(sceneFile, std::ios::binary | std::ios::trunc);
+    if (!output.is_open())
+    {
+        std::cerr << "Failed to write scene file: " << sceneFile << std::endl;
+        return false;
+    }
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char *>(entities.data()), entities.size() * sizeof(SceneEntityRecord));
+    output.write(reinterpret_cast<const char *>(lights.data()), lights.size() * sizeof(SceneLightRecord));
+    output.write(strings.data().data(), strings.data().size());
+    return output.good();
+}
@@ -0,0 +1,86 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Compiled scene format: a header, fixed-size little-endian records and a
+// string table of NUL-terminated paths. Everything is addressed by byte
+// offset from the start of the file, so a mapped file is used in place.
+static constexpr uint32_t SCENE_FILE_MAGIC = 0x43534743u; // "CGSC"
+static constexpr uint32_t SCENE_FILE_VERSION = 2;
+static constexpr uint32_t SCENE_NO_STRING = 0xFFFFFFFFu;
+static constexpr uint32_t SCENE_NO_PARENT = 0xFFFFFFFFu;
+
+struct SceneFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entityCount, entityOffset;
+    uint32_t lightCount, lightOffset;
+    uint32_t stringTableSize, stringTableOffset;
+    float cameraPosition[3];
+    float cameraFront[3];
+    float cameraUp[3];
+    float cameraFov;
+    float keyLightPosition[3];
+    uint32_t reserved;
+};
+
+struct SceneEntityRecord
+{
+    float position[3];
+    float rotation[3]; // radians
+    float scale;
+    uint32_t parent;   // record index, or SCENE_NO_PARENT
+    uint32_t name, obj, mtl, texture, trajectory; // string table offsets
+    uint32_t rotateAxis; // 'x', 'y', 'z' or 0
+    float speed;         // along the trajectory, world units per second (version 2)
+};
+
+struct SceneLightRecord
+{
+    float position[3];
+    float radius;
+    float color[3]; // already multiplied by the intensity
+    float reserved;
+};
+
+static_assert(sizeof(SceneFileHeader) == 88, "SceneFileHeader layout changed");
+static_assert(sizeof(SceneEntityRecord) == 60, "SceneEntityRecord layout changed");
+static_assert(sizeof(SceneLightRecord) == 32, "SceneLightRecord layout changed");
+
+// Read-only memory mapping of a compiled scene.
+class SceneFile
+{
+public:
+    SceneFile() = default;
+    ~SceneFile() { close(); }
+    SceneFile(const SceneFile &) = delete;
+    SceneFile &operator=(const SceneFile &) = delete;
+
+    // Maps the file and validates the header and section bounds.
+    bool open(const std::string &path);
+    void close();
+
+    const SceneFileHeader &header() const { return *reinterpret_cast<const SceneFileHeader *>(data); }
+    const SceneEntityRecord *entities() const { return reinterpret_cast<const SceneEntityRecord *>(data + header().entityOffset); }
+    const SceneLightRecord *lights() const { return reinterpret_cast<const SceneLightRecord *>(data + header().lightOffset); }
+    const char *string(uint32_t offset) const;
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// Streams scene.json into the compiled format; parent names become indices.
+bool compileScene(const std::string &jsonFile, const std::string &sceneFile);
+
+#endif
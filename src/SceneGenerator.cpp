@@ -0,0 +1,43 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "StressScene.h"
+
+// Gera uma cena de estresse no formato do scene.json.
+// Uso: SceneGenerator saida.json [numEntidades] [malhas] [texturas] [fracaoAnimada] [fracaoRotacao] [--partition]
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Uso: SceneGenerator saida.json [numEntidades] [malhas] [texturas] [fracaoAnimada] [fracaoRotacao] [--partition]"
+                  << std::endl;
+        return 1;
+    }
+
+    StressSceneSettings settings;
+    int position = 0;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--partition") == 0)
+        {
+            settings.partitioned = true;
+            continue;
+        }
+        switch (position++)
+        {
+        case 0: settings.entityCount = std::strtoul(argv[i], nullptr, 10); break;
+        case 1: settings.meshCount = std::atoi(argv[i]); break;
+        case 2: settings.textureCount = std::atoi(argv[i]); break;
+        case 3: settings.animatedFraction = std::strtof(argv[i], nullptr); break;
+        case 4: settings.rotatingFraction = std::strtof(argv[i], nullptr); break;
+        default: break;
+        }
+    }
+
+    if (!writeStressScene(argv[1], settings))
+        return 1;
+    std::cout << argv[1] << ": " << settings.entityCount << " entities" << std::endl;
+    return 0;
+}
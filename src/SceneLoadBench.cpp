@@ -0,0 +1,115 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include "SceneFile.h"
+#include "SceneStream.h"
+#include "json.hpp"
+
+// Compara o carregamento de uma cena grande em JSON (DOM e SAX do nlohmann)
+// com o formato binário compilado (mmap + iteração dos registros).
+// Uso: SceneLoadBench [numEntidades] [repeticoes]
+
+using json = nlohmann::json;
+
+template <typename Fn>
+static double measureMs(int repetitions, Fn &&fn)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        fn();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+static void writeLargeScene(const std::string &path, size_t entityCount)
+{
+    static const char *meshes[] = {"Cube", "LUA", "Suzanne"};
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+
+    std::ofstream out(path);
+    out << "{\n  \"camera\": {\"position\": [0.0, 0.0, 5.0], \"front\": [0.0, 0.0, -1.0], \"up\": [0.0, 1.0, 0.0], \"fov\": 80.0},\n";
+    out << "  \"light\": {\"position\": [1.0, 1.2, -0.5]},\n  \"entities\": [\n";
+    for (size_t i = 0; i < entityCount; ++i)
+    {
+        const char *mesh = meshes[i % 3];
+        out << "    {\"name\": \"e" << i << "\", \"obj\": \"../assets/Modelos3D/" << mesh << ".obj\", \"mtl\": \"../assets/Modelos3D/"
+            << mesh << ".mtl\", \"texture\": \"../assets/tex/pixelWall.png\", \"position\": [" << position(rng) << ", "
+            << position(rng) << ", " << position(rng) << "], \"rotation\": [0.0, " << angle(rng)
+            << ", 0.0], \"scale\": 0.5, \"trajectory\": \"\"";
+        if (i % 10 == 9)
+            out << ", \"parent\": \"e" << i - 1 << "\"";
+        out << "}" << (i + 1 < entityCount ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char **argv)
+{
+    size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    const std::string jsonPath = "SceneLoadBench.json";
+    const std::string scenePath = "SceneLoadBench.scene";
+    writeLargeScene(jsonPath, entityCount);
+
+    // Same lookups as loadSceneFromJSON, minus the asset loading.
+    double checksum = 0.0;
+    double jsonMs = measureMs(repetitions, [&]
+                              {
+        std::ifstream file(jsonPath);
+        json scene;
+        file >> scene;
+        for (const auto &obj : scene["entities"])
+        {
+            checksum += float(obj["position"][0]) + float(obj["rotation"][1]) + float(obj["scale"]);
+            checksum += obj["obj"].get<std::string>().size() + obj["texture"].get<std::string>().size();
+        } });
+
+    double saxChecksum = 0.0;
+    SceneStreamHandlers handlers;
+    handlers.onEntity = [&](const SceneEntityDescription &entity)
+    {
+        saxChecksum += entity.position.x + entity.rotation.y + entity.scale;
+        saxChecksum += entity.obj.size() + entity.texture.size();
+    };
+    double saxMs = measureMs(repetitions, [&]
+                             { streamSceneJSON(jsonPath, handlers); });
+
+    double compileMs = measureMs(1, [&]
+                                 { compileScene(jsonPath, scenePath); });
+
+    double binaryChecksum = 0.0;
+    double binaryMs = measureMs(repetitions, [&]
+                                {
+        SceneFile file;
+        if (!file.open(scenePath))
+            return;
+        const SceneEntityRecord *records = file.entities();
+        for (uint32_t i = 0; i < file.header().entityCount; ++i)
+        {
+            binaryChecksum += records[i].position[0] + records[i].rotation[1] + records[i].scale;
+            binaryChecksum += std::strlen(file.string(records[i].obj)) + std::strlen(file.string(records[i].texture));
+        } });
+
+    std::cout << "Entities: " << entityCount << std::endl;
+    std::cout << "JSON (DOM):      " << jsonMs << " ms" << std::endl;
+    std::cout << "JSON (SAX):      " << saxMs << " ms" << std::endl;
+    std::cout << "compile:         " << compileMs << " ms (once, offline)" << std::endl;
+    std::cout << "binary (mmap):   " << binaryMs << " ms" << std::endl;
+    if (binaryMs > 0.0)
+        std::cout << "speedup:         " << jsonMs / binaryMs << "x" << std::endl;
+
+    if (checksum == 0.0 || saxChecksum == 0.0 || binaryChecksum == 0.0)
+        std::cerr << "Warning: empty checksum" << std::endl;
+
+    std::remove(jsonPath.c_str());
+    std::remove(scenePath.c_str());
+    return 0;
+}
@@ -0,0 +1,238 @@
+#include "SceneStream.h"
+#include "json.hpp"
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using json = nlohmann::json;
+
+// Tracks where in the document the parser is, and fills the description of
+// the object currently open. Unknown keys and nested values are skipped.
+class SceneSaxHandler : public nlohmann::json_sax<json>
+{
+public:
+    explicit SceneSaxHandler(const SceneStreamHandlers &handlers) : handlers(handlers) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return number(static_cast<float>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return number(static_cast<float>(value)); }
+    bool number_float(number_float_t value, const string_t &) override { return number(static_cast<float>(value)); }
+    bool binary(binary_t &) override { return true; }
+
+    bool string(string_t &value) override
+    {
+        if (stack.back().section != ENTITY)
+            return true;
+        if (currentKey == "obj")
+            entity.obj = std::move(value);
+        else if (currentKey == "mtl")
+            entity.mtl = std::move(value);
+        else if (currentKey == "texture")
+            entity.texture = std::move(value);
+        else if (currentKey == "trajectory")
+            entity.trajectory = std::move(value);
+        else if (currentKey == "name")
+            entity.name = std::move(value);
+        else if (currentKey == "parent")
+            entity.parent = std::move(value);
+        else if (currentKey == "rotate")
+            entity.rotateAxis = value.size() == 1 && value[0] >= 'x' && value[0] <= 'z' ? value[0] : 0;
+        return true;
+    }
+
+    bool key(string_t &value) override
+    {
+        currentKey = std::move(value);
+        return true;
+    }
+
+    bool start_object(std::size_t) override
+    {
+        Section parent = stack.empty() ? DOCUMENT : stack.back().section;
+        Section section = SKIP;
+        if (parent == DOCUMENT)
+            section = ROOT;
+        else if (parent == ROOT && currentKey == "camera")
+            section = CAMERA;
+        else if (parent == ROOT && currentKey == "light")
+            section = KEY_LIGHT;
+        else if (parent == ROOT && currentKey == "partition")
+        {
+            section = PARTITION;
+            partition = ScenePartitionDescription();
+        }
+        else if (parent == LIGHTS)
+        {
+            section = LIGHT;
+            light = SceneLightDescription();
+            intensity = 1.0f;
+        }
+        else if (parent == ENTITIES)
+        {
+            section = ENTITY;
+            entity = SceneEntityDescription();
+        }
+        stack.push_back({section, nullptr, 0});
+        return true;
+    }
+
+    bool end_object() override
+    {
+        Section section = stack.back().section;
+        stack.pop_back();
+        if (section == CAMERA && handlers.onCamera)
+            handlers.onCamera(camera);
+        else if (section == KEY_LIGHT && handlers.onKeyLight)
+            handlers.onKeyLight(keyLight);
+        else if (section == PARTITION && handlers.onPartition)
+            handlers.onPartition(partition);
+        else if (section == LIGHT && handlers.onLight)
+        {
+            light.color *= intensity;
+            handlers.onLight(light);
+        }
+        else if (section == ENTITY && handlers.onEntity)
+        {
+            entity.rotation = glm::radians(entity.rotation);
+            handlers.onEntity(entity);
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        Section parent = stack.back().section;
+        Frame frame = {SKIP, nullptr, 0};
+        if (parent == ROOT && currentKey == "entities")
+            frame.section = ENTITIES;
+        else if (parent == ROOT && currentKey == "lights")
+            frame.section = LIGHTS;
+        else if (parent != SKIP && parent != ROOT)
+        {
+            frame.vector = vectorTarget(parent);
+            if (frame.vector)
+                frame.section = VECTOR;
+        }
+        stack.push_back(frame);
+        return true;
+    }
+
+    bool end_array() override
+    {
+        stack.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &error) override
+    {
+        std::cerr << "Scene JSON error at byte " << position << ": " << error.what() << std::endl;
+        return false;
+    }
+
+private:
+    enum Section
+    {
+        DOCUMENT,
+        ROOT,
+        CAMERA,
+        KEY_LIGHT,
+        PARTITION,
+        LIGHTS,
+        LIGHT,
+        ENTITIES,
+        ENTITY,
+        VECTOR,
+        SKIP
+    };
+
+    struct Frame
+    {
+        Section section;
+        glm::vec3 *vector; // target of a VECTOR frame
+        int index;
+    };
+
+    const SceneStreamHandlers &handlers;
+    std::vector<Frame> stack;
+    std::string currentKey;
+
+    SceneCameraDescription camera;
+    glm::vec3 keyLight = SCENE_DEFAULT_KEY_LIGHT;
+    SceneLightDescription light;
+    float intensity = 1.0f;
+    SceneEntityDescription entity;
+    ScenePartitionDescription partition;
+
+    glm::vec3 *vectorTarget(Section section)
+    {
+        if (section == CAMERA)
+        {
+            if (currentKey == "position")
+                return &camera.position;
+            if (currentKey == "front")
+                return &camera.front;
+            if (currentKey == "up")
+                return &camera.up;
+        }
+        else if (section == KEY_LIGHT && currentKey == "position")
+            return &keyLight;
+        else if (section == LIGHT)
+        {
+            if (currentKey == "position")
+                return &light.position;
+            if (currentKey == "color")
+                return &light.color;
+        }
+        else if (section == ENTITY)
+        {
+            if (currentKey == "position")
+                return &entity.position;
+            if (currentKey == "rotation")
+                return &entity.rotation;
+        }
+        return nullptr;
+    }
+
+    bool number(float value)
+    {
+        Frame &frame = stack.back();
+        if (frame.section == VECTOR)
+        {
+            if (frame.index < 3)
+                (*frame.vector)[frame.index++] = value;
+        }
+        else if (frame.section == CAMERA && currentKey == "fov")
+            camera.fov = value;
+        else if (frame.section == LIGHT && currentKey == "radius")
+            light.radius = value;
+        else if (frame.section == LIGHT && currentKey == "intensity")
+            intensity = value;
+        else if (frame.section == ENTITY && currentKey == "scale")
+            entity.scale = value;
+        else if (frame.section == ENTITY && currentKey == "speed")
+            entity.speed = value;
+        else if (frame.section == PARTITION && currentKey == "cellSize")
+            partition.cellSize = value;
+        else if (frame.section == PARTITION && currentKey == "loadRadius")
+            partition.loadRadius = value;
+        else if (frame.section == PARTITION && currentKey == "unloadRadius")
+            partition.unloadRadius = value;
+        else if (frame.section == PARTITION && currentKey == "maxCells")
+            partition.maxResidentCells = static_cast<int>(value);
+        return true;
+    }
+};
+
+bool streamSceneJSON(const std::string &jsonFile, const SceneStreamHandlers &handlers)
+{
+    std::ifstream file(jsonFile, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open JSON scene file: " << jsonFile << std::endl;
+        return false;
+    }
+
+    SceneSaxHandler sax(handlers);
+    return json::sax_parse(file, &sax);
+}
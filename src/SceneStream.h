@@ -0,0 +1,62 @@
+#ifndef SCENE_STREAM_H
+#define SCENE_STREAM_H
+
+#include <functional>
+#include <string>
+#include <glm/glm.hpp>
+
+struct SceneCameraDescription
+{
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 5.0f);
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+    float fov = 45.0f;
+};
+
+// Key light of a scene without a "light" object, in every scene format.
+const glm::vec3 SCENE_DEFAULT_KEY_LIGHT = glm::vec3(0.0f, 5.0f, 5.0f);
+
+struct SceneLightDescription
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 color = glm::vec3(1.0f); // already multiplied by the intensity
+    float radius = 5.0f;
+};
+
+struct SceneEntityDescription
+{
+    std::string name, parent;
+    std::string obj, mtl, texture, trajectory;
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f); // radians
+    float scale = 1.0f;
+    char rotateAxis = 0; // 'x', 'y' or 'z' spins the entity about that axis
+    float speed = 1.0f;  // along the trajectory, in world units per second
+};
+
+// Optional "partition" object: entities are bucketed into square XZ cells and
+// streamed around the camera instead of being loaded up front.
+struct ScenePartitionDescription
+{
+    float cellSize = 32.0f;
+    float loadRadius = 64.0f;
+    float unloadRadius = 96.0f; // > loadRadius, so cells at the border do not thrash
+    int maxResidentCells = 64;
+};
+
+// Called as soon as the corresponding JSON object closes; descriptions are
+// only valid during the call.
+struct SceneStreamHandlers
+{
+    std::function<void(const SceneCameraDescription &)> onCamera;
+    std::function<void(const glm::vec3 &)> onKeyLight;
+    std::function<void(const SceneLightDescription &)> onLight;
+    std::function<void(const SceneEntityDescription &)> onEntity;
+    std::function<void(const ScenePartitionDescription &)> onPartition;
+};
+
+// Parses scene.json with nlohmann's SAX interface: no DOM is built and only
+// the entity being parsed is held in memory.
+bool streamSceneJSON(const std::string &jsonFile, const SceneStreamHandlers &handlers);
+
+#endif
@@ -0,0 +1,75 @@
+#include "ShaderProgram.h"
+#include "GLExtensions.h"
+#include <iostream>
+
+static bool checkShader(GLuint shader, const char *type)
+{
+    GLint success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        GLchar infoLog[1024];
+        glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+        std::cerr << "| ERROR::SHADER-COMPILATION-ERROR of type: " << type << "\n"
+                  << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+    }
+    return success;
+}
+
+static GLuint compileShader(GLenum type, const GLchar *source, const char *typeName)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    checkShader(shader, typeName);
+    return shader;
+}
+
+static void checkProgram(GLuint program)
+{
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        GLchar infoLog[1024];
+        glGetProgramInfoLog(program, 1024, NULL, infoLog);
+        std::cerr << "| ERROR::PROGRAM-LINKING-ERROR of type: PROGRAM\n"
+                  << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+    }
+}
+
+GLuint buildShaderProgram(const GLchar *vertexSource, const GLchar *fragmentSource)
+{
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource, "VERTEX");
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource, "FRAGMENT");
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    checkProgram(program);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return program;
+}
+
+GLuint buildComputeProgram(const GLchar *computeSource)
+{
+    GLuint computeShader = compileShader(GL_COMPUTE_SHADER, computeSource, "COMPUTE");
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, computeShader);
+    glLinkProgram(program);
+    checkProgram(program);
+
+    glDeleteShader(computeShader);
+    return program;
+}
+
+void bindUniformBlock(GLuint program, const char *blockName, GLuint binding)
+{
+    GLuint index = glGetUniformBlockIndex(program, blockName);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, binding);
+}
@@ -0,0 +1,15 @@
+#ifndef SHADER_PROGRAM_H
+#define SHADER_PROGRAM_H
+
+#include <glad/glad.h>
+
+// Compiles and links a vertex + fragment program; errors are logged and the
+// (possibly unusable) program handle is still returned.
+GLuint buildShaderProgram(const GLchar *vertexSource, const GLchar *fragmentSource);
+
+GLuint buildComputeProgram(const GLchar *computeSource);
+
+// Binds a named uniform block to a binding point if the program declares it.
+void bindUniformBlock(GLuint program, const char *blockName, GLuint binding);
+
+#endif
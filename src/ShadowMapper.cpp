@@ -0,0 +1,268 @@
+#include "ShadowMapper.h"
+#include "Entity.h"
+#include "GLState.h"
+#include "ShaderProgram.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+const char *const SHADOW_MAPPING_GLSL = R"glsl(
+    uniform sampler2DShadow staticShadowMap;
+    uniform sampler2DShadow dynamicShadowMap;
+
+    // 1 when lit, 0 when both layers are in front; 2x2 PCF from the comparison samplers.
+    float shadowVisibility(mat4 lightMatrix, vec3 fragPos, vec3 norm, vec3 lightDir) {
+        vec4 lightClip = lightMatrix * vec4(fragPos + norm * 0.01, 1.0);
+        if (lightClip.w <= 0.0)
+            return 1.0;
+        vec3 coord = lightClip.xyz / lightClip.w * 0.5 + 0.5;
+        if (any(lessThan(coord, vec3(0.0))) || any(greaterThan(coord, vec3(1.0))))
+            return 1.0;
+        coord.z -= max(0.0015 * (1.0 - dot(norm, lightDir)), 0.0003);
+        return min(texture(staticShadowMap, coord), texture(dynamicShadowMap, coord));
+    }
+)glsl";
+
+static const GLchar *shadowVertexSource = R"glsl(
+    #version 410 core
+    layout(location = 0) in vec3 position;
+
+    layout(std140) uniform ObjectData {
+        mat4 model;
+        vec4 material;
+    };
+    uniform mat4 lightViewProjection;
+
+    void main() {
+        gl_Position = lightViewProjection * model * vec4(position, 1.0);
+    }
+)glsl";
+
+static const GLchar *shadowFragmentSource = R"glsl(
+    #version 410 core
+    void main() {
+    }
+)glsl";
+
+void ShadowMapper::TexelRect::expand(const TexelRect &other)
+{
+    if (other.empty())
+        return;
+    if (empty())
+    {
+        *this = other;
+        return;
+    }
+    x0 = std::min(x0, other.x0);
+    y0 = std::min(y0, other.y0);
+    x1 = std::max(x1, other.x1);
+    y1 = std::max(y1, other.y1);
+}
+
+void ShadowMapper::initialize()
+{
+    program = buildShaderProgram(shadowVertexSource, shadowFragmentSource);
+    bindUniformBlock(program, "ObjectData", Entity::OBJECT_UNIFORM_BINDING);
+
+    for (Layer *layer : {&staticLayer, &dynamicLayer})
+    {
+        glGenTextures(1, &layer->depthTexture);
+        glState.bindTexture(GL_TEXTURE_2D, layer->depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, SIZE, SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+        glGenFramebuffers(1, &layer->framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, layer->framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, layer->depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Shadow map framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glState.bindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ShadowMapper::release()
+{
+    if (program)
+        glState.deleteProgram(program);
+    program = 0;
+    for (Layer *layer : {&staticLayer, &dynamicLayer})
+    {
+        if (layer->depthTexture)
+            glState.deleteTexture(layer->depthTexture);
+        if (layer->framebuffer)
+            glDeleteFramebuffers(1, &layer->framebuffer);
+        *layer = Layer();
+    }
+}
+
+void ShadowMapper::invalidateStatic()
+{
+    staticDirty = true;
+}
+
+void ShadowMapper::objectMoved(const Entity &entity)
+{
+    if (!entity.isAnimated())
+        staticDirty = true;
+}
+
+void ShadowMapper::fitLightFrustum(const std::vector<Entity> &entities, const glm::vec3 &lightPosition)
+{
+    AABB sceneBounds;
+    for (const Entity &entity : entities)
+        sceneBounds.expand(entity.getWorldAABB());
+    if (!sceneBounds.isValid())
+        return;
+
+    glm::vec3 center = sceneBounds.center();
+    float radius = glm::length(sceneBounds.extents());
+    glm::vec3 toCenter = center - lightPosition;
+    float distance = glm::length(toCenter);
+
+    glm::vec3 direction = distance > 1e-4f ? toCenter / distance : glm::vec3(0.0f, -1.0f, 0.0f);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+    // A light inside the scene bounds only shadows what lies in a wide cone toward the center.
+    float fov = distance > radius * 1.05f ? 2.0f * std::asin(radius / distance) : glm::radians(120.0f);
+    float nearPlane = std::max(distance - radius, 0.05f);
+    float farPlane = distance + radius;
+
+    glm::mat4 view = glm::lookAt(lightPosition, lightPosition + direction, up);
+    lightMatrix = glm::perspective(fov, 1.0f, nearPlane, farPlane) * view;
+}
+
+ShadowMapper::TexelRect ShadowMapper::lightSpaceRect(const Entity &entity) const
+{
+    TexelRect full = {0, 0, SIZE, SIZE};
+    AABB box = entity.getWorldAABB();
+    if (!box.isValid())
+        return TexelRect(); // no mesh yet, nothing to draw
+
+    glm::vec2 ndcMin(1.0f), ndcMax(-1.0f);
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner((i & 1) ? box.max.x : box.min.x,
+                         (i & 2) ? box.max.y : box.min.y,
+                         (i & 4) ? box.max.z : box.min.z);
+        glm::vec4 clip = lightMatrix * glm::vec4(corner, 1.0f);
+        if (clip.w <= 0.0f)
+            return full;
+        glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    // Two texels of padding cover the PCF footprint and the rasterization of edges.
+    TexelRect rect;
+    rect.x0 = std::max(0, static_cast<int>(std::floor((ndcMin.x * 0.5f + 0.5f) * SIZE)) - 2);
+    rect.y0 = std::max(0, static_cast<int>(std::floor((ndcMin.y * 0.5f + 0.5f) * SIZE)) - 2);
+    rect.x1 = std::min(SIZE, static_cast<int>(std::ceil((ndcMax.x * 0.5f + 0.5f) * SIZE)) + 2);
+    rect.y1 = std::min(SIZE, static_cast<int>(std::ceil((ndcMax.y * 0.5f + 0.5f) * SIZE)) + 2);
+    return rect;
+}
+
+void ShadowMapper::renderLayer(const Layer &layer, std::vector<Entity> &entities, bool animated,
+                               const TexelRect &rect, StreamRingBuffer &uniformRing)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+    glViewport(0, 0, SIZE, SIZE);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(rect.x0, rect.y0, rect.x1 - rect.x0, rect.y1 - rect.y0);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+    glState.useProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "lightViewProjection"), 1, GL_FALSE, glm::value_ptr(lightMatrix));
+    for (Entity &entity : entities)
+        if (entity.isAnimated() == animated)
+            entity.drawDepth(uniformRing);
+    glDisable(GL_POLYGON_OFFSET_FILL);
+
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ShadowMapper::update(std::vector<Entity> &entities, const glm::vec3 &lightPosition, StreamRingBuffer &uniformRing)
+{
+    if (cachedAnimated.size() != entities.size())
+    {
+        cachedAnimated.assign(entities.size(), false);
+        staticDirty = true;
+    }
+    for (size_t i = 0; i < entities.size(); ++i)
+    {
+        bool animated = entities[i].isAnimated();
+        if (animated != cachedAnimated[i])
+        {
+            cachedAnimated[i] = animated;
+            staticDirty = true;
+        }
+    }
+    if (lightPosition != cachedLightPosition)
+        staticDirty = true;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    const TexelRect full = {0, 0, SIZE, SIZE};
+    if (staticDirty)
+    {
+        fitLightFrustum(entities, lightPosition);
+        renderLayer(staticLayer, entities, false, full, uniformRing);
+        cachedLightPosition = lightPosition;
+        staticDirty = false;
+        staticRenders++;
+        // The light matrix may have changed, so nothing left in the dynamic layer is valid.
+        previousDynamicRect = full;
+    }
+
+    TexelRect dynamicRect;
+    dynamicCasters = 0;
+    for (const Entity &entity : entities)
+    {
+        if (!entity.isAnimated())
+            continue;
+        dynamicRect.expand(lightSpaceRect(entity));
+        dynamicCasters++;
+    }
+
+    TexelRect dirty = dynamicRect;
+    dirty.expand(previousDynamicRect);
+    lastDirtyTexels = dirty.empty() ? 0 : (dirty.x1 - dirty.x0) * (dirty.y1 - dirty.y0);
+    if (!dirty.empty())
+        renderLayer(dynamicLayer, entities, true, dirty, uniformRing);
+    previousDynamicRect = dynamicRect;
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void ShadowMapper::bind() const
+{
+    glState.bindTextureUnit(STATIC_UNIT, GL_TEXTURE_2D, staticLayer.depthTexture);
+    glState.bindTextureUnit(DYNAMIC_UNIT, GL_TEXTURE_2D, dynamicLayer.depthTexture);
+}
+
+void ShadowMapper::setupProgram(GLuint program)
+{
+    glState.useProgram(program);
+    glUniform1i(glGetUniformLocation(program, "staticShadowMap"), STATIC_UNIT);
+    glUniform1i(glGetUniformLocation(program, "dynamicShadowMap"), DYNAMIC_UNIT);
+}
+
+void ShadowMapper::printStats() const
+{
+    std::cout << "Shadows: static layer rendered " << staticRenders << " times, " << dynamicCasters
+              << " dynamic casters, dirty region " << 100.0 * lastDirtyTexels / (double(SIZE) * SIZE)
+              << "% of the dynamic layer" << std::endl;
+}
@@ -0,0 +1,83 @@
+#ifndef SHADOW_MAPPER_H
+#define SHADOW_MAPPER_H
+
+#include <cstdint>
+#include <vector>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class Entity;
+class StreamRingBuffer;
+
+// Shadows of the key light from a perspective shadow map aimed at the scene.
+// Casters are split in two layers that the lit shaders combine with min():
+//  - static: entities that neither rotate nor follow a trajectory, rendered
+//    only when the light moves or the static set changes;
+//  - dynamic: animated entities, re-rendered every frame but only inside the
+//    light-space rectangle they cover now or covered last frame.
+class ShadowMapper
+{
+public:
+    static constexpr int SIZE = 2048;
+    static constexpr GLuint STATIC_UNIT = 9;
+    static constexpr GLuint DYNAMIC_UNIT = 10;
+
+    void initialize();
+    void release();
+
+    // A non-animated entity moved (e.g. via the keyboard), so the static layer is stale.
+    void objectMoved(const Entity &entity);
+    // Entities were added or removed, or a mesh finished uploading: casters
+    // drawn without geometry before must be picked up.
+    void invalidateStatic();
+    // Call after the entity transforms are up to date for the frame.
+    void update(std::vector<Entity> &entities, const glm::vec3 &lightPosition, StreamRingBuffer &uniformRing);
+    void bind() const;
+
+    const glm::mat4 &lightViewProjection() const { return lightMatrix; }
+
+    // Points the program's shadow samplers at our units.
+    static void setupProgram(GLuint program);
+
+    void printStats() const;
+
+private:
+    struct TexelRect
+    {
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+        bool empty() const { return x0 >= x1 || y0 >= y1; }
+        void expand(const TexelRect &other);
+    };
+
+    struct Layer
+    {
+        GLuint framebuffer = 0;
+        GLuint depthTexture = 0;
+    };
+
+    Layer staticLayer, dynamicLayer;
+    GLuint program = 0;
+
+    glm::mat4 lightMatrix = glm::mat4(1.0f);
+    glm::vec3 cachedLightPosition = glm::vec3(0.0f);
+    std::vector<bool> cachedAnimated;
+    bool staticDirty = true;
+
+    // Region of the dynamic layer written last frame, which must be cleared again.
+    TexelRect previousDynamicRect;
+
+    unsigned int staticRenders = 0;
+    unsigned int dynamicCasters = 0;
+    int lastDirtyTexels = 0;
+
+    void fitLightFrustum(const std::vector<Entity> &entities, const glm::vec3 &lightPosition);
+    TexelRect lightSpaceRect(const Entity &entity) const;
+    void renderLayer(const Layer &layer, std::vector<Entity> &entities, bool animated,
+                     const TexelRect &rect, StreamRingBuffer &uniformRing);
+};
+
+// shadowVisibility(), inserted after the version line of every lit fragment shader.
+extern const char *const SHADOW_MAPPING_GLSL;
+
+#endif
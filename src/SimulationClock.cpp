@@ -0,0 +1,41 @@
+#include "SimulationClock.h"
+#include <iostream>
+
+void SimulationClock::setTickRate(double ticksPerSecond)
+{
+    if (ticksPerSecond > 0.0)
+        tickLength = 1.0 / ticksPerSecond;
+    if (accumulator >= tickLength)
+        accumulator = 0.0;
+}
+
+int SimulationClock::advance(double realTime)
+{
+    // The first call only starts the clock.
+    if (lastRealTime < 0.0)
+    {
+        lastRealTime = realTime;
+        return 0;
+    }
+    accumulator += realTime - lastRealTime;
+    lastRealTime = realTime;
+    ++frames;
+
+    int steps = static_cast<int>(accumulator / tickLength);
+    if (steps > MAX_TICKS_PER_FRAME)
+    {
+        droppedSeconds += (steps - MAX_TICKS_PER_FRAME) * tickLength;
+        steps = MAX_TICKS_PER_FRAME;
+    }
+    accumulator -= static_cast<int>(accumulator / tickLength) * tickLength;
+    ticks += steps;
+    if (steps == 0)
+        ++idleFrames;
+    return steps;
+}
+
+void SimulationClock::printStats() const
+{
+    std::cout << "Simulation: " << 1.0 / tickLength << " Hz, " << ticks << " ticks over " << frames << " frames ("
+              << idleFrames << " interpolation only), " << droppedSeconds << " s dropped" << std::endl;
+}
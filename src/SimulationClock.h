@@ -0,0 +1,41 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <cstdint>
+
+// Fixed-step simulation time, independent of the render rate. Each frame
+// hands the real time to advance(), which returns how many whole ticks to
+// simulate; the remainder stays in the accumulator, and alpha() tells how far
+// the frame is between the last two simulated states, for interpolation.
+class SimulationClock
+{
+public:
+    // A stall longer than this many ticks (loading, a breakpoint) is dropped
+    // instead of being caught up in one burst.
+    static constexpr int MAX_TICKS_PER_FRAME = 8;
+
+    explicit SimulationClock(double ticksPerSecond = 60.0) { setTickRate(ticksPerSecond); }
+
+    void setTickRate(double ticksPerSecond);
+    int advance(double realTime);
+
+    float tickSeconds() const { return static_cast<float>(tickLength); }
+    // Simulation time of the latest tick.
+    double time() const { return ticks * tickLength; }
+    float alpha() const { return static_cast<float>(accumulator / tickLength); }
+    // The time alpha() corresponds to, between the previous and the latest tick.
+    double renderTime() const { return time() - tickLength + accumulator; }
+
+    void printStats() const;
+
+private:
+    double tickLength = 1.0 / 60.0;
+    double accumulator = 0.0;
+    double lastRealTime = -1.0;
+    uint64_t ticks = 0;
+    uint64_t frames = 0;
+    uint64_t idleFrames = 0; // frames that only interpolated
+    double droppedSeconds = 0.0;
+};
+
+#endif
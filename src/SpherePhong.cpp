@@ -19,6 +19,9 @@ using namespace std;
 // GLFW
 #include <GLFW/glfw3.h>
 
+// Cache de estado da OpenGL (evita binds redundantes)
+#include "GLState.h"
+
 // GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -171,7 +174,7 @@ int main()
 	vec3 camPos = vec3(0.0,0.0,-3.0);
 
 
-	glUseProgram(shaderID);
+	glState.useProgram(shaderID);
 
 	// Enviar a informação de qual variável armazenará o buffer da textura
 	glUniform1i(glGetUniformLocation(shaderID, "texBuff"), 0);
@@ -184,7 +187,7 @@ int main()
 	glUniform3f(glGetUniformLocation(shaderID, "camPos"), camPos.x,camPos.y,camPos.z);
 
 	//Ativando o primeiro buffer de textura da OpenGL
-	glActiveTexture(GL_TEXTURE0);
+	glState.activeTexture(GL_TEXTURE0);
 	
 
 	// Matriz de projeção paralela ortográfica
@@ -201,25 +204,24 @@ int main()
 	{
 		// Checa se houveram eventos de input (key pressed, mouse moved etc.) e chama as funções de callback correspondentes
 		glfwPollEvents();
+		glState.beginFrame();
 
 		// Limpa o buffer de cor
 		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // cor de fundo
 		glClear(GL_COLOR_BUFFER_BIT);
 
-		glBindVertexArray(VAO); // Conectando ao buffer de geometria
-		glBindTexture(GL_TEXTURE_2D, texID); //conectando com o buffer de textura que será usado no draw
+		glState.bindVertexArray(VAO); // Conectando ao buffer de geometria
+		glState.bindTexture(GL_TEXTURE_2D, texID); //conectando com o buffer de textura que será usado no draw
 
 		// Primeiro Triângulo
 		drawGeometry(shaderID, VAO, vec3(0, 0, 0), vec3(1, 1, 1), 0.0, nVertices);
 
 	
-		glBindVertexArray(0); // Desconectando o buffer de geometria
-
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
-	glDeleteVertexArrays(1, &VAO);
+	glState.deleteVertexArray(VAO);
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
 	glfwTerminate();
 	return 0;
@@ -309,7 +311,7 @@ int setupGeometry()
 	// Geração do identificador do VBO
 	glGenBuffers(1, &VBO);
 	// Faz a conexão (vincula) do buffer como um buffer de array
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glState.bindBuffer(GL_ARRAY_BUFFER, VBO);
 	// Envia os dados do array de floats para o buffer da OpenGl
 	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
@@ -317,7 +319,7 @@ int setupGeometry()
 	glGenVertexArrays(1, &VAO);
 	// Vincula (bind) o VAO primeiro, e em seguida  conecta e seta o(s) buffer(s) de vértices
 	// e os ponteiros para os atributos
-	glBindVertexArray(VAO);
+	glState.bindVertexArray(VAO);
 	// Para cada atributo do vertice, criamos um "AttribPointer" (ponteiro para o atributo), indicando:
 	//  Localização no shader * (a localização dos atributos devem ser correspondentes no layout especificado no vertex shader)
 	//  Numero de valores que o atributo tem (por ex, 3 coordenadas xyz)
@@ -340,10 +342,10 @@ int setupGeometry()
 
 	// Observe que isso é permitido, a chamada para glVertexAttribPointer registrou o VBO como o objeto de buffer de vértice
 	// atualmente vinculado - para que depois possamos desvincular com segurança
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glState.bindBuffer(GL_ARRAY_BUFFER, 0);
 
 	// Desvincula o VAO (é uma boa prática desvincular qualquer buffer ou array para evitar bugs medonhos)
-	glBindVertexArray(0);
+	glState.bindVertexArray(0);
 
 	return VAO;
 }
@@ -354,7 +356,7 @@ GLuint loadTexture(string filePath, int &width, int &height)
 
 	// Gera o identificador da textura na memória
 	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_2D, texID);
+	glState.bindTexture(GL_TEXTURE_2D, texID);
 
 	// Ajuste dos parâmetros de wrapping e filtering
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -387,7 +389,7 @@ GLuint loadTexture(string filePath, int &width, int &height)
 
 	stbi_image_free(data);
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	glState.bindTexture(GL_TEXTURE_2D, 0);
 
 	return texID;
 }
@@ -462,9 +464,9 @@ GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVert
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    glState.bindVertexArray(VAO);
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glState.bindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
 
     // Layout da posição (location 0)
@@ -483,7 +485,8 @@ glEnableVertexAttribArray(2);
 glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(9 * sizeof(GLfloat)));
 glEnableVertexAttribArray(3);
 
-    glBindVertexArray(0);
+    glState.bindBuffer(GL_ARRAY_BUFFER, 0);
+    glState.bindVertexArray(0);
 
     nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
 
@@ -0,0 +1,199 @@
+#include "SplinePath.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static CubicSegment bezierSegment(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3)
+{
+    CubicSegment s;
+    s.c[0] = p0;
+    s.c[1] = 3.0f * (p1 - p0);
+    s.c[2] = 3.0f * (p0 - 2.0f * p1 + p2);
+    s.c[3] = -p0 + 3.0f * p1 - 3.0f * p2 + p3;
+    return s;
+}
+
+// Uniform Catmull-Rom from p1 to p2, with p0 and p3 as neighbours.
+static CubicSegment catmullRomSegment(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3)
+{
+    CubicSegment s;
+    s.c[0] = p1;
+    s.c[1] = 0.5f * (p2 - p0);
+    s.c[2] = 0.5f * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3);
+    s.c[3] = 0.5f * (-p0 + 3.0f * p1 - 3.0f * p2 + p3);
+    return s;
+}
+
+static void buildSegments(SplineType type, const std::vector<glm::vec3> &values, float scale,
+                          std::vector<CubicSegment> &segments)
+{
+    segments.clear();
+    size_t n = values.size();
+    auto value = [&](size_t i) { return values[i] * scale; };
+
+    if (type == SPLINE_BEZIER)
+    {
+        for (size_t i = 0; i + 3 < n; i += 3)
+            segments.push_back(bezierSegment(value(i), value(i + 1), value(i + 2), value(i + 3)));
+        return;
+    }
+
+    // Closed loops take their end neighbours from across the seam (skipping
+    // the repeated point); open ends mirror the next point.
+    bool closed = n > 2 && values.front() == values.back();
+    for (size_t i = 0; i + 1 < n; ++i)
+    {
+        glm::vec3 p1 = value(i), p2 = value(i + 1);
+        glm::vec3 p0 = i > 0 ? value(i - 1) : (closed ? value(n - 2) : 2.0f * p1 - p2);
+        glm::vec3 p3 = i + 2 < n ? value(i + 2) : (closed ? value(1) : 2.0f * p2 - p1);
+        segments.push_back(catmullRomSegment(p0, p1, p2, p3));
+    }
+}
+
+static double gaussLength(const CubicSegment &segment, double a, double b)
+{
+    double half = 0.5 * (b - a), mid = 0.5 * (a + b), sum = 0.0;
+    for (int i = 0; i < 5; ++i)
+        sum += SplinePath::GAUSS_WEIGHTS[i] *
+               glm::length(segment.derivative(static_cast<float>(mid + half * SplinePath::GAUSS_NODES[i])));
+    return sum * half;
+}
+
+// Halves the interval until the two halves agree with the whole; cusps and
+// tight turns get subdivided, straight stretches are done in one step.
+static double adaptiveLength(const CubicSegment &segment, double a, double b, double whole, double tolerance, int depth)
+{
+    double mid = 0.5 * (a + b);
+    double left = gaussLength(segment, a, mid), right = gaussLength(segment, mid, b);
+    if (depth == 0 || std::abs(left + right - whole) <= tolerance)
+        return left + right;
+    return adaptiveLength(segment, a, mid, left, 0.5 * tolerance, depth - 1) +
+           adaptiveLength(segment, mid, b, right, 0.5 * tolerance, depth - 1);
+}
+
+bool SplinePath::build(SplineType type, const std::vector<glm::vec3> &points, const std::vector<glm::vec3> &rotations)
+{
+    positionSegments.clear();
+    rotationSegments.clear();
+    arcLengths.clear();
+
+    if (!rotations.empty() && rotations.size() != points.size())
+    {
+        std::cerr << "A curva precisa de uma rotação por ponto ou de nenhuma." << std::endl;
+        return false;
+    }
+    if (type == SPLINE_BEZIER && (points.size() < 4 || (points.size() - 1) % 3 != 0))
+    {
+        std::cerr << "Curvas Bézier precisam de 3k + 1 pontos de controle (4, 7, 10, ...); recebidos "
+                  << points.size() << "." << std::endl;
+        return false;
+    }
+    if (type == SPLINE_CATMULL_ROM && points.size() < 2)
+    {
+        std::cerr << "Curvas Catmull-Rom precisam de pelo menos 2 pontos." << std::endl;
+        return false;
+    }
+
+    buildSegments(type, points, 1.0f, positionSegments);
+    if (!rotations.empty())
+        buildSegments(type, rotations, glm::radians(1.0f), rotationSegments);
+    buildArcLengthTable();
+    return true;
+}
+
+void SplinePath::buildArcLengthTable()
+{
+    arcLengths.clear();
+    arcLengths.reserve(positionSegments.size() * ARC_SAMPLES_PER_SEGMENT + 1);
+    double total = 0.0;
+    arcLengths.push_back(0.0f);
+    for (const CubicSegment &segment : positionSegments)
+    {
+        for (int k = 0; k < ARC_SAMPLES_PER_SEGMENT; ++k)
+        {
+            double a = double(k) / ARC_SAMPLES_PER_SEGMENT, b = double(k + 1) / ARC_SAMPLES_PER_SEGMENT;
+            double whole = gaussLength(segment, a, b);
+            total += adaptiveLength(segment, a, b, whole, 1e-6 * std::max(whole, 1e-3), 8);
+            arcLengths.push_back(static_cast<float>(total));
+        }
+    }
+}
+
+float SplinePath::arcLength(const CubicSegment &segment, float a, float b)
+{
+    float half = 0.5f * (b - a), mid = 0.5f * (a + b), sum = 0.0f;
+    for (int i = 0; i < 5; ++i)
+        sum += GAUSS_WEIGHTS[i] * glm::length(segment.derivative(mid + half * GAUSS_NODES[i]));
+    return sum * half;
+}
+
+SplinePath::ArcInterval SplinePath::intervalAtDistance(float distance) const
+{
+    ArcInterval interval;
+    if (arcLengths.size() < 2)
+        return interval;
+
+    // First sample past distance; the one before it is <= distance.
+    size_t upper = std::upper_bound(arcLengths.begin(), arcLengths.end(), distance) - arcLengths.begin();
+    upper = std::min(std::max<size_t>(upper, 1), arcLengths.size() - 1);
+    size_t lower = upper - 1;
+    interval.segment = static_cast<uint32_t>(lower / ARC_SAMPLES_PER_SEGMENT);
+    interval.t0 = float(lower % ARC_SAMPLES_PER_SEGMENT) * ARC_SAMPLE_STEP;
+    interval.s0 = arcLengths[lower];
+    interval.s1 = arcLengths[upper];
+    return interval;
+}
+
+float SplinePath::segmentParameter(const CubicSegment &segment, const ArcInterval &interval, float distance)
+{
+    float span = interval.s1 - interval.s0;
+    float fraction = span > 0.0f ? glm::clamp((distance - interval.s0) / span, 0.0f, 1.0f) : 0.0f;
+    float t = interval.t0 + fraction * ARC_SAMPLE_STEP;
+
+    // One Newton step corrects the linear guess where the speed changes
+    // quickly inside the sample.
+    float speed = glm::length(segment.derivative(t));
+    if (speed > 1e-6f)
+    {
+        float covered = interval.s0 + arcLength(segment, interval.t0, t);
+        t = glm::clamp(t - (covered - distance) / speed, interval.t0, interval.t0 + ARC_SAMPLE_STEP);
+    }
+    return t;
+}
+
+float SplinePath::parameterAtDistance(float distance) const
+{
+    if (arcLengths.size() < 2)
+        return 0.0f;
+    ArcInterval interval = intervalAtDistance(distance);
+    float t = segmentParameter(positionSegments[interval.segment], interval, distance);
+    return (interval.segment + t) / positionSegments.size();
+}
+
+size_t SplinePath::memoryBytes() const
+{
+    return (positionSegments.capacity() + rotationSegments.capacity()) * sizeof(CubicSegment) +
+           arcLengths.capacity() * sizeof(float);
+}
+
+const CubicSegment &SplinePath::locate(const std::vector<CubicSegment> &segments, float u, float &t)
+{
+    float x = glm::clamp(u, 0.0f, 1.0f) * segments.size();
+    size_t index = std::min(static_cast<size_t>(x), segments.size() - 1);
+    t = x - index;
+    return segments[index];
+}
+
+glm::vec3 SplinePath::position(float u) const
+{
+    float t;
+    const CubicSegment &segment = locate(positionSegments, u, t);
+    return segment.evaluate(t);
+}
+
+glm::vec3 SplinePath::rotation(float u) const
+{
+    float t;
+    const CubicSegment &segment = locate(rotationSegments, u, t);
+    return segment.evaluate(t);
+}
@@ -0,0 +1,91 @@
+#ifndef SPLINE_PATH_H
+#define SPLINE_PATH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+enum SplineType
+{
+    SPLINE_BEZIER,     // 3k + 1 points: anchor, two handles, anchor, ...
+    SPLINE_CATMULL_ROM // passes through every point
+};
+
+// One cubic piece in power form, p(t) = c0 + c1 t + c2 t^2 + c3 t^3 for t in
+// [0, 1], so evaluating it is a single Horner step per coefficient.
+struct CubicSegment
+{
+    glm::vec3 c[4];
+
+    glm::vec3 evaluate(float t) const { return ((c[3] * t + c[2]) * t + c[1]) * t + c[0]; }
+    glm::vec3 derivative(float t) const { return (3.0f * c[3] * t + 2.0f * c[2]) * t + c[1]; }
+};
+
+// Piecewise cubic path through positions and, optionally, rotations. The
+// control points are converted to polynomial coefficients once by build();
+// evaluation only picks the segment and runs Horner on it. build() also
+// tabulates the arc length, so the path can be walked at a constant speed.
+class SplinePath
+{
+public:
+    // rotations is either empty or one entry (degrees) per point. Bezier
+    // paths need 3k + 1 points, Catmull-Rom paths at least 2. A Catmull-Rom
+    // channel whose last point repeats the first is closed into a smooth loop.
+    bool build(SplineType type, const std::vector<glm::vec3> &points, const std::vector<glm::vec3> &rotations);
+
+    bool empty() const { return positionSegments.empty(); }
+    size_t segmentCount() const { return positionSegments.size(); }
+    bool hasRotation() const { return !rotationSegments.empty(); }
+    size_t memoryBytes() const;
+
+    // u in [0, 1] spans the whole path, every segment taking an equal share.
+    glm::vec3 position(float u) const;
+    glm::vec3 rotation(float u) const; // radians
+
+    float length() const { return arcLengths.empty() ? 0.0f : arcLengths.back(); }
+    // The u at which the path has covered distance (clamped to the length):
+    // a binary search in the arc-length table, linear interpolation between
+    // the two samples and one Newton step.
+    float parameterAtDistance(float distance) const;
+
+    // Arc-length table samples per segment.
+    static constexpr int ARC_SAMPLES_PER_SEGMENT = 16;
+    static constexpr float ARC_SAMPLE_STEP = 1.0f / ARC_SAMPLES_PER_SEGMENT;
+
+    // The table interval [s0, s1) that holds a distance: the segment, and
+    // the segment parameter t0 where the interval starts.
+    struct ArcInterval
+    {
+        uint32_t segment = 0;
+        float t0 = 0.0f;
+        float s0 = 0.0f, s1 = 0.0f;
+    };
+    ArcInterval intervalAtDistance(float distance) const;
+    const CubicSegment &positionSegment(size_t index) const { return positionSegments[index]; }
+    const CubicSegment &rotationSegment(size_t index) const { return rotationSegments[index]; }
+
+    // The two steps of parameterAtDistance after the search, on one segment;
+    // shared with the batch evaluators so every path gives the same answer.
+    static float segmentParameter(const CubicSegment &segment, const ArcInterval &interval, float distance);
+    // 5-point Gauss-Legendre estimate of the length between two parameters.
+    static float arcLength(const CubicSegment &segment, float a, float b);
+
+    static constexpr float GAUSS_NODES[5] = {0.0f, -0.5384693101056831f, 0.5384693101056831f, -0.9061798459386640f,
+                                             0.9061798459386640f};
+    static constexpr float GAUSS_WEIGHTS[5] = {0.5688888888888889f, 0.4786286704993665f, 0.4786286704993665f,
+                                               0.2369268850561891f, 0.2369268850561891f};
+
+private:
+    std::vector<CubicSegment> positionSegments;
+    std::vector<CubicSegment> rotationSegments;
+    // Length from the start to each table sample; ARC_SAMPLES_PER_SEGMENT
+    // entries per segment plus the final one.
+    std::vector<float> arcLengths;
+
+    void buildArcLengthTable();
+
+    static const CubicSegment &locate(const std::vector<CubicSegment> &segments, float u, float &t);
+};
+
+#endif
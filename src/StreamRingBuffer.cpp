@@ -0,0 +1,166 @@
+#include "StreamRingBuffer.h"
+#include "GLExtensions.h"
+#include "GLState.h"
+#include <iostream>
+
+static GLsizeiptr alignUp(GLsizeiptr value, GLsizeiptr alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+StreamRingBuffer::StreamRingBuffer(int framesInFlight)
+    : framesInFlight(framesInFlight), fences(framesInFlight, nullptr)
+{
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+}
+
+StreamRingBuffer::~StreamRingBuffer()
+{
+    release();
+}
+
+GLsizeiptr StreamRingBuffer::alignedSize(GLsizeiptr size) const
+{
+    return alignUp(size, alignment);
+}
+
+void StreamRingBuffer::reserve(GLsizeiptr bytesPerFrame)
+{
+    if (bufferID != 0 && bytesPerFrame <= regionSize)
+        return;
+
+    release();
+    create(bytesPerFrame);
+}
+
+void StreamRingBuffer::create(GLsizeiptr bytesPerFrame)
+{
+    regionSize = alignUp(bytesPerFrame, alignment);
+    GLsizeiptr totalSize = regionSize * framesInFlight;
+
+    glGenBuffers(1, &bufferID);
+    glState.bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+
+    persistent = glExt.bufferStorage;
+    if (persistent)
+    {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glExt.BufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        persistentPtr = static_cast<unsigned char *>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+        if (!persistentPtr)
+        {
+            std::cerr << "Failed to persistently map stream buffer, falling back to per-frame maps" << std::endl;
+            glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+            glState.deleteBuffer(bufferID);
+            glGenBuffers(1, &bufferID);
+            glState.bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+            persistent = false;
+        }
+    }
+    if (!persistent)
+    {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+    frameIndex = 0;
+    overflowReported = false;
+}
+
+void StreamRingBuffer::release()
+{
+    for (GLsync &fence : fences)
+        waitFence(fence);
+
+    if (bufferID != 0)
+    {
+        if (persistentPtr || frameBase)
+        {
+            glState.bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        glState.deleteBuffer(bufferID);
+    }
+
+    bufferID = 0;
+    persistentPtr = nullptr;
+    frameBase = nullptr;
+}
+
+void StreamRingBuffer::waitFence(GLsync &fence)
+{
+    if (!fence)
+        return;
+
+    GLbitfield flags = 0;
+    GLuint64 timeout = 0;
+    while (true)
+    {
+        GLenum result = glClientWaitSync(fence, flags, timeout);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+            break;
+        flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        timeout = 1000000000; // 1s
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamRingBuffer::beginFrame()
+{
+    waitFence(fences[frameIndex]);
+
+    GLintptr regionOffset = regionSize * frameIndex;
+    if (persistent)
+    {
+        frameBase = persistentPtr + regionOffset;
+    }
+    else
+    {
+        glState.bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+        frameBase = static_cast<unsigned char *>(glMapBufferRange(
+            GL_UNIFORM_BUFFER, regionOffset, regionSize,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+        glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    frameCursor = 0;
+    frameCounter++;
+}
+
+void StreamRingBuffer::endFrame()
+{
+    if (!persistent && frameBase)
+    {
+        glState.bindBuffer(GL_UNIFORM_BUFFER, bufferID);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glState.bindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    frameBase = nullptr;
+
+    fences[frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    frameIndex = (frameIndex + 1) % framesInFlight;
+}
+
+void *StreamRingBuffer::allocate(GLsizeiptr size, GLintptr &outOffset)
+{
+    GLsizeiptr start = alignUp(frameCursor, alignment);
+    if (!frameBase || start + size > regionSize)
+    {
+        if (!overflowReported)
+        {
+            std::cerr << "Stream ring buffer full (" << regionSize << " bytes per frame)" << std::endl;
+            overflowReported = true;
+        }
+        return nullptr;
+    }
+
+    frameCursor = start + size;
+    outOffset = regionSize * frameIndex + start;
+    return frameBase + start;
+}
+
+void StreamRingBuffer::bindRange(GLuint bindingPoint, GLintptr offset, GLsizeiptr size) const
+{
+    glState.bindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, bufferID, offset, size);
+}
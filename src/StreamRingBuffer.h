@@ -0,0 +1,70 @@
+#ifndef STREAM_RING_BUFFER_H
+#define STREAM_RING_BUFFER_H
+
+#include <vector>
+#include <glad/glad.h>
+
+// Uniform buffer split into one region per frame in flight. Each region is
+// guarded by a fence, so the CPU writes straight into mapped memory while the
+// GPU is still reading the regions of previous frames.
+//
+// With GL 4.4 / ARB_buffer_storage the buffer is mapped once (persistent and
+// coherent). Otherwise each region is mapped with GL_MAP_UNSYNCHRONIZED_BIT,
+// which is safe because the fences already provide the synchronization.
+class StreamRingBuffer
+{
+public:
+    explicit StreamRingBuffer(int framesInFlight = 3);
+    ~StreamRingBuffer();
+
+    StreamRingBuffer(const StreamRingBuffer &) = delete;
+    StreamRingBuffer &operator=(const StreamRingBuffer &) = delete;
+
+    // (Re)creates the storage if a frame needs more than the current region size.
+    void reserve(GLsizeiptr bytesPerFrame);
+    void release();
+
+    GLsizeiptr alignedSize(GLsizeiptr size) const;
+
+    void beginFrame();
+    void endFrame();
+
+    // Returns a pointer into mapped memory, or nullptr if the frame region is full.
+    void *allocate(GLsizeiptr size, GLintptr &outOffset);
+
+    template <typename T>
+    T *allocate(GLintptr &outOffset)
+    {
+        return static_cast<T *>(allocate(sizeof(T), outOffset));
+    }
+
+    void bindRange(GLuint bindingPoint, GLintptr offset, GLsizeiptr size) const;
+
+    // Increases on every beginFrame; lets callers reuse one allocation per frame.
+    unsigned long long frameNumber() const { return frameCounter; }
+
+    GLuint buffer() const { return bufferID; }
+    bool isPersistent() const { return persistent; }
+
+private:
+    int framesInFlight;
+    int frameIndex = 0;
+    unsigned long long frameCounter = 0;
+
+    GLuint bufferID = 0;
+    GLsizeiptr regionSize = 0;
+    GLint alignment = 256;
+    bool persistent = false;
+
+    unsigned char *persistentPtr = nullptr;
+    unsigned char *frameBase = nullptr;
+    GLsizeiptr frameCursor = 0;
+    bool overflowReported = false;
+
+    std::vector<GLsync> fences;
+
+    void create(GLsizeiptr bytesPerFrame);
+    void waitFence(GLsync &fence);
+};
+
+#endif
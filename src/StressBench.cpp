@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "StressScene.h"
+
+// Gera cenas de estresse com 10 a 100k entidades e roda o Hello3D em modo
+// headless (--benchmark) sobre cada uma, resumindo carga, frame e draw calls.
+// Uso: StressBench [caminhoHello3D] [frames] [--partition]
+
+int main(int argc, char **argv)
+{
+    std::string hello3D = "./Hello3D";
+    int frames = 300;
+    bool partitioned = false;
+    int position = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--partition")
+            partitioned = true;
+        else if (position++ == 0)
+            hello3D = arg;
+        else
+            frames = std::atoi(argv[i]);
+    }
+
+    const std::string csvFile = "StressBench.csv";
+    std::remove(csvFile.c_str());
+
+    const size_t entityCounts[] = {10, 100, 1000, 10000, 100000};
+    for (size_t entityCount : entityCounts)
+    {
+        StressSceneSettings settings;
+        settings.entityCount = entityCount;
+        settings.partitioned = partitioned;
+        std::string scene = "stress_" + std::to_string(entityCount) + ".json";
+        if (!writeStressScene(scene, settings))
+            return 1;
+
+        std::string command = "\"" + hello3D + "\" --scene " + scene + " --benchmark " + std::to_string(frames) +
+                              " --benchmark-csv " + csvFile;
+        std::cout << "Running " << command << std::endl;
+        if (std::system(command.c_str()) != 0)
+            std::cerr << "Hello3D failed for " << entityCount << " entities" << std::endl;
+    }
+
+    // Hello3D appends one line per run: entities,loadMs,frameMs,maxFrameMs,gpuSceneMs,drawCalls
+    std::ifstream results(csvFile);
+    if (!results.is_open())
+    {
+        std::cerr << "No results in " << csvFile << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(10) << "entities" << std::setw(12) << "load ms" << std::setw(12) << "frame ms"
+              << std::setw(12) << "max ms" << std::setw(12) << "gpu ms" << "draw calls" << std::endl;
+    static const int widths[] = {10, 12, 12, 12, 12, 0};
+    std::string line;
+    while (std::getline(results, line))
+    {
+        std::istringstream ss(line);
+        std::string field;
+        for (int column = 0; column < 6 && std::getline(ss, field, ','); ++column)
+            std::cout << std::setw(widths[column]) << field;
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "StressScene.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Meshes and textures shipped in assets/, relative to the asset root.
+static const char *STRESS_MESHES[] = {"Modelos3D/Cube", "Modelos3D/LUA", "Modelos3D/Suzanne", "Modelos3D/SuzanneSubdiv1"};
+static const char *STRESS_TEXTURES[] = {"tex/pixelWall.png", "tex/LUAA.jpg", "Modelos3D/Suzanne.png", "Modelos3D/SuzanneUV.png"};
+static const int STRESS_MESH_COUNT = sizeof(STRESS_MESHES) / sizeof(STRESS_MESHES[0]);
+static const int STRESS_TEXTURE_COUNT = sizeof(STRESS_TEXTURES) / sizeof(STRESS_TEXTURES[0]);
+
+// Animated entities share this many loops instead of getting one file each.
+static const int STRESS_TRAJECTORY_FILES = 16;
+
+static int clampCount(int requested, int available, const char *what)
+{
+    if (requested > available)
+        std::cerr << "Only " << available << " " << what << " available, using " << available << std::endl;
+    return std::max(1, std::min(requested, available));
+}
+
+bool writeStressScene(const std::string &jsonFile, const StressSceneSettings &settings)
+{
+    int meshCount = clampCount(settings.meshCount, STRESS_MESH_COUNT, "meshes");
+    int textureCount = clampCount(settings.textureCount, STRESS_TEXTURE_COUNT, "textures");
+
+    float side = std::sqrt(std::max<size_t>(settings.entityCount, 1) / std::max(settings.entitiesPerSquareUnit, 1e-3f));
+    float half = side * 0.5f;
+    const float height = 4.0f;
+
+    std::mt19937 rng(settings.seed);
+    std::uniform_real_distribution<float> spread(-half, half);
+    std::uniform_real_distribution<float> lift(-height, height);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    std::uniform_real_distribution<float> size(0.2f, 0.8f);
+
+    // Trajectories are 4 control points with a rotation each, written beside the scene.
+    size_t extension = jsonFile.rfind(".json");
+    std::string stem = extension == std::string::npos ? jsonFile : jsonFile.substr(0, extension);
+    std::vector<std::string> trajectories;
+    if (settings.animatedFraction > 0.0f)
+    {
+        for (int t = 0; t < STRESS_TRAJECTORY_FILES; ++t)
+        {
+            std::string path = stem + "_traj" + std::to_string(t) + ".txt";
+            std::ofstream out(path);
+            if (!out.is_open())
+            {
+                std::cerr << "Failed to write trajectory: " << path << std::endl;
+                return false;
+            }
+            float cx = spread(rng), cy = lift(rng), cz = spread(rng), radius = 2.0f + 4.0f * unit(rng);
+            out << cx - radius << " " << cy << " " << cz << " 0 0 0\n";
+            out << cx - radius << " " << cy + radius << " " << cz + radius << " 0 120 0\n";
+            out << cx + radius << " " << cy - radius << " " << cz + radius << " 0 240 0\n";
+            out << cx + radius << " " << cy << " " << cz << " 0 360 0\n";
+            trajectories.push_back(path);
+        }
+    }
+
+    std::ofstream out(jsonFile);
+    if (!out.is_open())
+    {
+        std::cerr << "Failed to write scene: " << jsonFile << std::endl;
+        return false;
+    }
+
+    out << "{\n  \"camera\": {\"position\": [0.0, 2.0, 0.0], \"front\": [0.0, 0.0, -1.0], \"up\": [0.0, 1.0, 0.0], \"fov\": 80.0},\n";
+    out << "  \"light\": {\"position\": [1.0, 20.0, -0.5]},\n";
+    if (settings.partitioned)
+        out << "  \"partition\": {\"cellSize\": 32.0, \"loadRadius\": 64.0, \"unloadRadius\": 96.0, \"maxCells\": 64},\n";
+
+    out << "  \"lights\": [\n";
+    for (int l = 0; l < settings.pointLightCount; ++l)
+    {
+        out << "    {\"position\": [" << spread(rng) * 0.1f << ", " << lift(rng) << ", " << -unit(rng) * 20.0f
+            << "], \"color\": [" << unit(rng) << ", " << unit(rng) << ", " << unit(rng)
+            << "], \"radius\": 6.0, \"intensity\": 2.0}" << (l + 1 < settings.pointLightCount ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"entities\": [\n";
+
+    static const char axes[] = {'x', 'y', 'z'};
+    for (size_t i = 0; i < settings.entityCount; ++i)
+    {
+        // Mesh and texture cycle at different rates so every pairing shows up.
+        std::string mesh = settings.assetRoot + "/" + STRESS_MESHES[i % meshCount];
+        std::string texture = settings.assetRoot + "/" + STRESS_TEXTURES[(i / meshCount) % textureCount];
+        bool animated = !trajectories.empty() && unit(rng) < settings.animatedFraction;
+        bool rotating = unit(rng) < settings.rotatingFraction;
+
+        out << "    {\"obj\": \"" << mesh << ".obj\", \"mtl\": \"" << mesh << ".mtl\", \"texture\": \"" << texture
+            << "\", \"position\": [" << spread(rng) << ", " << lift(rng) << ", " << spread(rng)
+            << "], \"rotation\": [0.0, " << angle(rng) << ", 0.0], \"scale\": " << size(rng) << ", \"trajectory\": \"";
+        if (animated)
+            out << trajectories[rng() % trajectories.size()];
+        out << "\"";
+        if (rotating)
+            out << ", \"rotate\": \"" << axes[rng() % 3] << "\"";
+        out << "}" << (i + 1 < settings.entityCount ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
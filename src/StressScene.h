@@ -0,0 +1,29 @@
+#ifndef STRESS_SCENE_H
+#define STRESS_SCENE_H
+
+#include <cstddef>
+#include <string>
+
+// Parameters of a procedurally generated scene.json used to stress the
+// renderer. Entities are scattered over a flat slab whose area grows with the
+// entity count, so the density around the camera stays the same as N scales.
+struct StressSceneSettings
+{
+    size_t entityCount = 1000;
+    int meshCount = 3;              // distinct meshes, clamped to the ones in assets/
+    int textureCount = 2;           // distinct textures, likewise
+    float animatedFraction = 0.1f;  // entities following a Bezier trajectory
+    float rotatingFraction = 0.25f; // entities spinning about a random axis
+    float entitiesPerSquareUnit = 0.25f;
+    int pointLightCount = 8;
+    bool partitioned = false;       // emit a "partition" object so the world is streamed
+    std::string assetRoot = "../assets";
+    unsigned int seed = 42;
+};
+
+// Writes the scene and, next to it, the trajectory files its animated
+// entities share. Paths inside the scene are relative to the working
+// directory, like the ones in assets/scene.json.
+bool writeStressScene(const std::string &jsonFile, const StressSceneSettings &settings);
+
+#endif
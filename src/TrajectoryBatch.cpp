@@ -0,0 +1,331 @@
+#include "TrajectoryBatch.h"
+#include "CpuFeatures.h"
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+
+TrajectoryBatch trajectoryBatch;
+
+static const float NEVER = std::numeric_limits<float>::infinity();
+
+bool TrajectoryBatch::hasSIMD()
+{
+    return cpuHasAVX2();
+}
+
+void TrajectoryBatch::resetLane(uint32_t lane)
+{
+    laneKey[lane] = NO_LANE;
+    lanePath[lane] = nullptr;
+    laneFlags[lane] = 0;
+    laneSegment[lane] = 0;
+    distance[lane] = speed[lane] = 0.0f;
+    t0[lane] = s0[lane] = 0.0f;
+    s1[lane] = NEVER; // never crosses, so it is never refilled
+    for (std::vector<float> &column : coefficients)
+        column[lane] = 0.0f;
+    outX[lane] = outY[lane] = outZ[lane] = 0.0f;
+    outRX[lane] = outRY[lane] = outRZ[lane] = 0.0f;
+}
+
+void TrajectoryBatch::moveLane(uint32_t from, uint32_t to)
+{
+    laneKey[to] = laneKey[from];
+    lanePath[to] = lanePath[from];
+    laneFlags[to] = laneFlags[from];
+    laneSegment[to] = laneSegment[from];
+    distance[to] = distance[from];
+    speed[to] = speed[from];
+    t0[to] = t0[from];
+    s0[to] = s0[from];
+    s1[to] = s1[from];
+    for (std::vector<float> &column : coefficients)
+        column[to] = column[from];
+    outX[to] = outX[from];
+    outY[to] = outY[from];
+    outZ[to] = outZ[from];
+    outRX[to] = outRX[from];
+    outRY[to] = outRY[from];
+    outRZ[to] = outRZ[from];
+}
+
+void TrajectoryBatch::add(uint32_t key, const SplinePath *path, float laneSpeed)
+{
+    if (key >= laneOfKey.size())
+        laneOfKey.resize(key + 1, NO_LANE);
+
+    uint32_t lane = laneOfKey[key];
+    if (lane == NO_LANE)
+    {
+        if (count == laneKey.size())
+        {
+            size_t padded = count + 8;
+            laneKey.resize(padded);
+            lanePath.resize(padded);
+            laneFlags.resize(padded);
+            laneSegment.resize(padded);
+            for (std::vector<float> *column : {&distance, &speed, &t0, &s0, &s1, &outX, &outY, &outZ, &outRX, &outRY, &outRZ})
+                column->resize(padded);
+            for (std::vector<float> &column : coefficients)
+                column.resize(padded);
+            for (size_t i = count; i < padded; ++i)
+                resetLane(static_cast<uint32_t>(i));
+        }
+        lane = static_cast<uint32_t>(count++);
+        laneOfKey[key] = lane;
+        ++waitingLanes;
+    }
+    else if (!isWaiting(lane))
+        ++waitingLanes;
+
+    resetLane(lane);
+    laneKey[lane] = key;
+    lanePath[lane] = path;
+    speed[lane] = laneSpeed;
+}
+
+void TrajectoryBatch::remove(uint32_t key)
+{
+    if (key >= laneOfKey.size() || laneOfKey[key] == NO_LANE)
+        return;
+
+    uint32_t lane = laneOfKey[key];
+    if (isWaiting(lane))
+        --waitingLanes;
+    uint32_t last = static_cast<uint32_t>(count - 1);
+    if (lane != last)
+    {
+        moveLane(last, lane);
+        laneOfKey[laneKey[lane]] = lane;
+    }
+    resetLane(last);
+    --count;
+    laneOfKey[key] = NO_LANE;
+}
+
+void TrajectoryBatch::setSpeed(uint32_t key, float laneSpeed)
+{
+    if (key < laneOfKey.size() && laneOfKey[key] != NO_LANE)
+        speed[laneOfKey[key]] = laneSpeed;
+}
+
+CubicSegment TrajectoryBatch::segment(uint32_t lane, int base) const
+{
+    CubicSegment s;
+    for (int k = 0; k < 4; ++k)
+        s.c[k] = glm::vec3(coefficients[base + k][lane], coefficients[base + 4 + k][lane], coefficients[base + 8 + k][lane]);
+    return s;
+}
+
+// Finds the interval of the lane's distance, wrapping past the path end, and
+// loads the coefficients of its segment.
+void TrajectoryBatch::locate(uint32_t lane)
+{
+    const SplinePath &path = *lanePath[lane];
+    float length = path.length();
+    if (distance[lane] >= length)
+    {
+        distance[lane] = length > 0.0f ? std::fmod(distance[lane], length) : 0.0f;
+        restarted.push_back(lane);
+    }
+
+    SplinePath::ArcInterval interval = path.intervalAtDistance(distance[lane]);
+    laneSegment[lane] = interval.segment;
+    t0[lane] = interval.t0;
+    s0[lane] = interval.s0;
+    s1[lane] = length > 0.0f ? interval.s1 : NEVER;
+
+    const CubicSegment &position = path.positionSegment(interval.segment);
+    for (int a = 0; a < 3; ++a)
+        for (int k = 0; k < 4; ++k)
+            coefficients[POSITION + a * 4 + k][lane] = position.c[k][a];
+    if (laneFlags[lane] & LANE_ROTATES)
+    {
+        const CubicSegment &rotation = path.rotationSegment(interval.segment);
+        for (int a = 0; a < 3; ++a)
+            for (int k = 0; k < 4; ++k)
+                coefficients[ROTATION + a * 4 + k][lane] = rotation.c[k][a];
+    }
+}
+
+void TrajectoryBatch::startLane(uint32_t lane)
+{
+    laneFlags[lane] = LANE_ACTIVE | (lanePath[lane]->hasRotation() ? LANE_ROTATES : 0);
+    distance[lane] = 0.0f;
+    locate(lane);
+    restarted.push_back(lane);
+    --waitingLanes;
+}
+
+void TrajectoryBatch::startWaitingLanes()
+{
+    if (waitingLanes == 0)
+        return;
+    for (uint32_t lane = 0; lane < count; ++lane)
+        if (isWaiting(lane) && !lanePath[lane]->empty())
+            startLane(lane);
+}
+
+void TrajectoryBatch::evaluateLane(uint32_t lane)
+{
+    CubicSegment position = segment(lane, POSITION);
+    SplinePath::ArcInterval interval;
+    interval.segment = laneSegment[lane];
+    interval.t0 = t0[lane];
+    interval.s0 = s0[lane];
+    interval.s1 = s1[lane];
+    float t = SplinePath::segmentParameter(position, interval, distance[lane]);
+
+    glm::vec3 p = position.evaluate(t);
+    outX[lane] = p.x;
+    outY[lane] = p.y;
+    outZ[lane] = p.z;
+    if (laneFlags[lane] & LANE_ROTATES)
+    {
+        glm::vec3 r = segment(lane, ROTATION).evaluate(t);
+        outRX[lane] = r.x;
+        outRY[lane] = r.y;
+        outRZ[lane] = r.z;
+    }
+}
+
+void TrajectoryBatch::advanceScalar(uint32_t begin, uint32_t end, float tickSeconds)
+{
+    for (uint32_t lane = begin; lane < end; ++lane)
+    {
+        distance[lane] += speed[lane] * tickSeconds;
+        if (distance[lane] >= s1[lane])
+            crossed.push_back(lane);
+        evaluateLane(lane);
+    }
+}
+
+#if defined(CG_AVX2_KERNELS)
+// Length of the derivative of 8 segments (one axis per c[a]) at t.
+CG_AVX2_TARGET static inline __m256 speedAt(const __m256 c1[3], const __m256 c2x2[3], const __m256 c3x3[3],
+                                                    __m256 t)
+{
+    __m256 sum = _mm256_setzero_ps();
+    for (int a = 0; a < 3; ++a)
+    {
+        __m256 d = _mm256_fmadd_ps(_mm256_fmadd_ps(c3x3[a], t, c2x2[a]), t, c1[a]);
+        sum = _mm256_fmadd_ps(d, d, sum);
+    }
+    return _mm256_sqrt_ps(sum);
+}
+
+CG_AVX2_TARGET static inline __m256 horner(const std::vector<float> *c, size_t i, __m256 t)
+{
+    __m256 v = _mm256_loadu_ps(&c[3][i]);
+    v = _mm256_fmadd_ps(v, t, _mm256_loadu_ps(&c[2][i]));
+    v = _mm256_fmadd_ps(v, t, _mm256_loadu_ps(&c[1][i]));
+    return _mm256_fmadd_ps(v, t, _mm256_loadu_ps(&c[0][i]));
+}
+
+// Same steps as advanceScalar + SplinePath::segmentParameter, 8 lanes at a time.
+CG_AVX2_TARGET static void advanceAVX2(size_t count, float tickSeconds, float *distance, const float *speed,
+                                               const float *t0, const float *s0, const float *s1,
+                                               const std::vector<float> *coefficients, float *out[6],
+                                               std::vector<uint32_t> &crossed)
+{
+    const __m256 dt = _mm256_set1_ps(tickSeconds);
+    const __m256 step = _mm256_set1_ps(SplinePath::ARC_SAMPLE_STEP);
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f);
+    const __m256 two = _mm256_set1_ps(2.0f), three = _mm256_set1_ps(3.0f), epsilon = _mm256_set1_ps(1e-6f);
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 d = _mm256_fmadd_ps(_mm256_loadu_ps(speed + i), dt, _mm256_loadu_ps(distance + i));
+        _mm256_storeu_ps(distance + i, d);
+        __m256 lo = _mm256_loadu_ps(s0 + i), hi = _mm256_loadu_ps(s1 + i), start = _mm256_loadu_ps(t0 + i);
+
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(d, hi, _CMP_GE_OQ)));
+        for (; mask; mask &= mask - 1)
+            crossed.push_back(static_cast<uint32_t>(i + lowestBit(mask)));
+
+        __m256 span = _mm256_sub_ps(hi, lo);
+        __m256 fraction = _mm256_div_ps(_mm256_sub_ps(d, lo), span);
+        fraction = _mm256_and_ps(fraction, _mm256_cmp_ps(span, zero, _CMP_GT_OQ));
+        fraction = _mm256_min_ps(_mm256_max_ps(fraction, zero), one);
+        __m256 t = _mm256_fmadd_ps(fraction, step, start);
+
+        __m256 c1[3], c2x2[3], c3x3[3];
+        for (int a = 0; a < 3; ++a)
+        {
+            c1[a] = _mm256_loadu_ps(&coefficients[a * 4 + 1][i]);
+            c2x2[a] = _mm256_mul_ps(two, _mm256_loadu_ps(&coefficients[a * 4 + 2][i]));
+            c3x3[a] = _mm256_mul_ps(three, _mm256_loadu_ps(&coefficients[a * 4 + 3][i]));
+        }
+
+        // Newton step on the arc length covered from t0.
+        __m256 halfWidth = _mm256_mul_ps(half, _mm256_sub_ps(t, start));
+        __m256 middle = _mm256_mul_ps(half, _mm256_add_ps(t, start));
+        __m256 sum = zero;
+        for (int g = 0; g < 5; ++g)
+        {
+            __m256 x = _mm256_fmadd_ps(halfWidth, _mm256_set1_ps(SplinePath::GAUSS_NODES[g]), middle);
+            sum = _mm256_fmadd_ps(_mm256_set1_ps(SplinePath::GAUSS_WEIGHTS[g]), speedAt(c1, c2x2, c3x3, x), sum);
+        }
+        __m256 covered = _mm256_fmadd_ps(sum, halfWidth, lo);
+        __m256 velocity = speedAt(c1, c2x2, c3x3, t);
+        __m256 corrected = _mm256_sub_ps(t, _mm256_div_ps(_mm256_sub_ps(covered, d), velocity));
+        corrected = _mm256_min_ps(_mm256_max_ps(corrected, start), _mm256_add_ps(start, step));
+        t = _mm256_blendv_ps(t, corrected, _mm256_cmp_ps(velocity, epsilon, _CMP_GT_OQ));
+
+        for (int a = 0; a < 6; ++a)
+            _mm256_storeu_ps(out[a] + i, horner(coefficients + a * 4, i, t));
+    }
+}
+#endif
+
+void TrajectoryBatch::advanceSIMD(float tickSeconds)
+{
+#if defined(CG_AVX2_KERNELS)
+    float *out[6] = {outX.data(), outY.data(), outZ.data(), outRX.data(), outRY.data(), outRZ.data()};
+    advanceAVX2(count, tickSeconds, distance.data(), speed.data(), t0.data(), s0.data(), s1.data(), coefficients, out,
+                crossed);
+#else
+    advanceScalar(0, static_cast<uint32_t>(count), tickSeconds);
+#endif
+}
+
+// Crossed lanes were evaluated in their old interval; move them on and redo them.
+void TrajectoryBatch::refillCrossedLanes()
+{
+    for (uint32_t lane : crossed)
+    {
+        locate(lane);
+        evaluateLane(lane);
+    }
+    lastRefills = crossed.size();
+}
+
+void TrajectoryBatch::update(float tickSeconds)
+{
+    if (!hasSIMD())
+    {
+        updateScalar(tickSeconds);
+        return;
+    }
+    restarted.clear();
+    crossed.clear();
+    startWaitingLanes();
+    advanceSIMD(tickSeconds);
+    refillCrossedLanes();
+}
+
+void TrajectoryBatch::updateScalar(float tickSeconds)
+{
+    restarted.clear();
+    crossed.clear();
+    startWaitingLanes();
+    advanceScalar(0, static_cast<uint32_t>(count), tickSeconds);
+    refillCrossedLanes();
+}
+
+void TrajectoryBatch::printStats() const
+{
+    std::cout << "Trajectory batch: " << count << " lanes (" << waitingLanes << " waiting for their path), "
+              << (hasSIMD() ? "AVX2" : "scalar") << ", " << lastRefills << " interval refills last tick" << std::endl;
+}
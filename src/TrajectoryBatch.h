@@ -0,0 +1,90 @@
+#ifndef TRAJECTORY_BATCH_H
+#define TRAJECTORY_BATCH_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SplinePath.h"
+
+// Every trajectory follower as one lane of structure-of-arrays state: the
+// distance covered, the speed, the arc-length interval the distance is in
+// and the coefficients of the segment that interval belongs to. A tick is
+// one fused pass over all lanes (advance, invert the arc length, evaluate
+// position and rotation), 8 lanes per iteration on AVX2. A lane only goes
+// back to its SplinePath when it crosses into the next table interval.
+// Lanes are keyed by the owner's EntityHandle slot, which survives row swaps.
+// Arrays are padded to a multiple of 8 with lanes that never move.
+class TrajectoryBatch
+{
+public:
+    static constexpr uint32_t NO_LANE = 0xFFFFFFFFu;
+
+    // The path must stay alive while the lane exists; an empty path leaves
+    // the lane waiting until the path is loaded. Replaces any lane of key.
+    void add(uint32_t key, const SplinePath *path, float speed);
+    void remove(uint32_t key);
+    void setSpeed(uint32_t key, float speed);
+
+    // Advances every lane by one tick and evaluates it at its new distance.
+    void update(float tickSeconds);
+    void updateScalar(float tickSeconds);
+    static bool hasSIMD();
+
+    // Results of the last update, per lane.
+    size_t size() const { return count; }
+    size_t waitingCount() const { return waitingLanes; }
+    uint32_t key(uint32_t lane) const { return laneKey[lane]; }
+    bool isWaiting(uint32_t lane) const { return !(laneFlags[lane] & LANE_ACTIVE); }
+    bool rotates(uint32_t lane) const { return laneFlags[lane] & LANE_ROTATES; }
+    glm::vec3 position(uint32_t lane) const { return glm::vec3(outX[lane], outY[lane], outZ[lane]); }
+    glm::vec3 rotation(uint32_t lane) const { return glm::vec3(outRX[lane], outRY[lane], outRZ[lane]); }
+    // Lanes that started or jumped back to the path start in the last update;
+    // their new state should not be interpolated from the old one.
+    const std::vector<uint32_t> &restartedLanes() const { return restarted; }
+
+    void printStats() const;
+
+private:
+    enum LaneFlag : uint8_t
+    {
+        LANE_ACTIVE = 1 << 0, // the path has loaded
+        LANE_ROTATES = 1 << 1,
+    };
+
+    // Coefficient arrays: power k of axis a is coefficients[base + a * 4 + k].
+    static constexpr int POSITION = 0;
+    static constexpr int ROTATION = 12;
+    static constexpr int COEFFICIENT_ARRAYS = 24;
+
+    size_t count = 0;
+    std::vector<uint32_t> laneOfKey;
+    std::vector<uint32_t> laneKey;
+    std::vector<const SplinePath *> lanePath;
+    std::vector<uint8_t> laneFlags;
+    std::vector<uint32_t> laneSegment;
+    std::vector<float> distance, speed;
+    std::vector<float> t0, s0, s1; // current arc-length interval
+    std::vector<float> coefficients[COEFFICIENT_ARRAYS];
+    std::vector<float> outX, outY, outZ, outRX, outRY, outRZ;
+
+    std::vector<uint32_t> crossed; // lanes past the end of their interval
+    std::vector<uint32_t> restarted;
+    size_t waitingLanes = 0;
+    size_t lastRefills = 0;
+
+    void resetLane(uint32_t lane);
+    void moveLane(uint32_t from, uint32_t to);
+    void startLane(uint32_t lane);
+    void locate(uint32_t lane);
+    CubicSegment segment(uint32_t lane, int base) const;
+
+    void startWaitingLanes();
+    void advanceScalar(uint32_t begin, uint32_t end, float tickSeconds);
+    void advanceSIMD(float tickSeconds);
+    void evaluateLane(uint32_t lane);
+    void refillCrossedLanes();
+};
+
+extern TrajectoryBatch trajectoryBatch;
+
+#endif
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "SplinePath.h"
+#include "TrajectoryBatch.h"
+
+// Mede a construção das tabelas de comprimento de arco e a avaliação por
+// frame de N trajetórias aleatórias (padrão: 10k), comparando o avanço pelo
+// parâmetro da curva com o avanço por distância (velocidade constante), uma
+// trajetória por vez e em lote (TrajectoryBatch, escalar e AVX2).
+// Uso: TrajectoryBench [numTrajetorias] [frames]
+
+template <typename Fn>
+static double measureMs(int repetitions, Fn &&fn)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repetitions; ++r)
+        fn();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+// Ratio between the longest and the shortest step over one walk of the path.
+// Each step is measured along the curve (8 chords), so sharp turns do not
+// read as short steps.
+template <typename Fn>
+static float stepRatio(const SplinePath &path, int steps, Fn &&parameterAtStep)
+{
+    float shortest = 1e30f, longest = 0.0f;
+    float previous = parameterAtStep(0);
+    for (int i = 1; i <= steps; ++i)
+    {
+        float current = parameterAtStep(i);
+        float step = 0.0f;
+        for (int k = 0; k < 8; ++k)
+            step += glm::length(path.position(previous + (current - previous) * (k + 1) / 8.0f) -
+                                path.position(previous + (current - previous) * k / 8.0f));
+        shortest = std::min(shortest, step);
+        longest = std::max(longest, step);
+        previous = current;
+    }
+    return shortest > 0.0f ? longest / shortest : 0.0f;
+}
+
+int main(int argc, char **argv)
+{
+    size_t pathCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    // Half Bezier, half Catmull-Rom, 2 to 5 segments each, with rotations.
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+    std::uniform_int_distribution<int> segments(2, 5);
+    std::vector<std::vector<glm::vec3>> points(pathCount), rotations(pathCount);
+    std::vector<SplineType> types(pathCount);
+    for (size_t i = 0; i < pathCount; ++i)
+    {
+        types[i] = i % 2 ? SPLINE_CATMULL_ROM : SPLINE_BEZIER;
+        int count = types[i] == SPLINE_BEZIER ? 3 * segments(rng) + 1 : segments(rng) + 1;
+        for (int p = 0; p < count; ++p)
+        {
+            points[i].emplace_back(position(rng), position(rng), position(rng));
+            rotations[i].emplace_back(0.0f, angle(rng), 0.0f);
+        }
+    }
+
+    std::vector<SplinePath> paths(pathCount);
+    double buildMs = measureMs(1, [&]
+                               {
+        for (size_t i = 0; i < pathCount; ++i)
+            paths[i].build(types[i], points[i], rotations[i]); });
+
+    // One simulated frame per repetition; both walks write the same outputs.
+    const float dt = 1.0f / 60.0f, speed = 5.0f;
+    std::vector<float> parameter(pathCount, 0.0f), distance(pathCount, 0.0f);
+    std::vector<glm::vec3> outPosition(pathCount), outRotation(pathCount);
+
+    double parameterMs = measureMs(frames, [&]
+                                   {
+        for (size_t i = 0; i < pathCount; ++i)
+        {
+            outPosition[i] = paths[i].position(parameter[i]);
+            outRotation[i] = paths[i].rotation(parameter[i]);
+            parameter[i] += 0.001f;
+            if (parameter[i] > 1.0f)
+                parameter[i] = 0.0f;
+        } });
+
+    double distanceMs = measureMs(frames, [&]
+                                  {
+        for (size_t i = 0; i < pathCount; ++i)
+        {
+            float u = paths[i].parameterAtDistance(distance[i]);
+            outPosition[i] = paths[i].position(u);
+            outRotation[i] = paths[i].rotation(u);
+            distance[i] += speed * dt;
+            if (distance[i] > paths[i].length())
+                distance[i] = std::fmod(distance[i], paths[i].length());
+        } });
+
+    // The same walk as one batch, every path a lane.
+    TrajectoryBatch scalarBatch, simdBatch;
+    for (size_t i = 0; i < pathCount; ++i)
+    {
+        scalarBatch.add(static_cast<uint32_t>(i), &paths[i], speed);
+        simdBatch.add(static_cast<uint32_t>(i), &paths[i], speed);
+    }
+    double batchScalarMs = measureMs(frames, [&]
+                                     { scalarBatch.updateScalar(dt); });
+    double batchSIMDMs = TrajectoryBatch::hasSIMD() ? measureMs(frames, [&]
+                                                                { simdBatch.update(dt); })
+                                                    : -1.0;
+
+    // Both batches have advanced as far as the per-path walk.
+    float batchError = 0.0f, simdError = 0.0f;
+    for (uint32_t lane = 0; lane < pathCount; ++lane)
+    {
+        const SplinePath &path = paths[scalarBatch.key(lane)];
+        float u = path.parameterAtDistance(distance[scalarBatch.key(lane)]);
+        batchError = std::max(batchError, glm::length(scalarBatch.position(lane) - path.position(u)));
+        batchError = std::max(batchError, glm::length(scalarBatch.rotation(lane) - path.rotation(u)));
+        if (batchSIMDMs >= 0.0)
+        {
+            simdError = std::max(simdError, glm::length(simdBatch.position(lane) - scalarBatch.position(lane)));
+            simdError = std::max(simdError, glm::length(simdBatch.rotation(lane) - scalarBatch.rotation(lane)));
+        }
+    }
+
+    // Speed uniformity over a sample of the paths.
+    const int steps = 1000;
+    float parameterRatio = 0.0f, distanceRatio = 0.0f;
+    size_t sampled = std::min<size_t>(pathCount, 100);
+    for (size_t i = 0; i < sampled; ++i)
+    {
+        const SplinePath &path = paths[i];
+        parameterRatio += stepRatio(path, steps, [&](int k)
+                                    { return float(k) / steps; });
+        distanceRatio += stepRatio(path, steps, [&](int k)
+                                   { return path.parameterAtDistance(path.length() * k / steps); });
+    }
+
+    size_t tableBytes = 0;
+    for (const SplinePath &path : paths)
+        tableBytes += path.memoryBytes();
+
+    std::cout << "Paths: " << pathCount << ", " << SplinePath::ARC_SAMPLES_PER_SEGMENT << " arc samples per segment"
+              << std::endl;
+    std::cout << "build (coefficients + arc length): " << buildMs << " ms, " << tableBytes / 1024.0 << " KB" << std::endl;
+    std::cout << "frame, uniform parameter:          " << parameterMs << " ms ("
+              << parameterMs * 1.0e6 / pathCount << " ns/path)" << std::endl;
+    std::cout << "frame, constant speed:             " << distanceMs << " ms ("
+              << distanceMs * 1.0e6 / pathCount << " ns/path)" << std::endl;
+    std::cout << "frame, batch scalar:               " << batchScalarMs << " ms ("
+              << batchScalarMs * 1.0e6 / pathCount << " ns/path)" << std::endl;
+    if (batchSIMDMs >= 0.0)
+        std::cout << "frame, batch AVX2:                 " << batchSIMDMs << " ms ("
+                  << batchSIMDMs * 1.0e6 / pathCount << " ns/path)" << std::endl;
+    else
+        std::cout << "frame, batch AVX2:                 not supported by this CPU/build" << std::endl;
+    std::cout << "max difference, batch vs per path: " << batchError << ", AVX2 vs scalar: " << simdError << std::endl;
+    std::cout << "longest/shortest step, parameter:  " << parameterRatio / sampled << std::endl;
+    std::cout << "longest/shortest step, distance:   " << distanceRatio / sampled << std::endl;
+
+    float checksum = 0.0f;
+    for (size_t i = 0; i < pathCount; ++i)
+        checksum += outPosition[i].x + outRotation[i].y;
+    if (checksum == 0.0f)
+        std::cerr << "Warning: empty checksum" << std::endl;
+    return 0;
+}
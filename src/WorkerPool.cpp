@@ -0,0 +1,81 @@
+#include "WorkerPool.h"
+
+WorkerPool workerPool;
+
+void WorkerPool::run(unsigned int count, TaskFunction function, void *context)
+{
+    if (count == 0)
+        return;
+    if (count == 1 || concurrency() == 1)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            function(context, i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (workers.empty())
+            for (unsigned int i = 1; i < concurrency(); ++i)
+                workers.emplace_back(&WorkerPool::workerLoop, this);
+        taskFunction = function;
+        taskContext = context;
+        taskCount = count;
+        nextTask = 0;
+        running = static_cast<unsigned int>(workers.size());
+        ++batch;
+    }
+    wake.notify_all();
+
+    claimTasks();
+
+    // Every worker must have left the batch before its task goes out of scope.
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]
+                  { return running == 0; });
+}
+
+void WorkerPool::claimTasks()
+{
+    for (unsigned int i = nextTask++; i < taskCount; i = nextTask++)
+        taskFunction(taskContext, i);
+}
+
+void WorkerPool::workerLoop()
+{
+    uint64_t seenBatch = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]
+                      { return stopping || batch != seenBatch; });
+            if (stopping)
+                return;
+            seenBatch = batch;
+        }
+
+        claimTasks();
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last = --running == 0;
+        }
+        if (last)
+            finished.notify_one();
+    }
+}
+
+void WorkerPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+        worker.join();
+    workers.clear();
+    stopping = false;
+}
@@ -0,0 +1,58 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Threads that live for the whole run and split per-frame loops between
+// them and the calling thread. The threads start on the first parallelFor;
+// after that a call neither creates threads nor touches the heap, which a
+// std::thread per chunk and frame did.
+class WorkerPool
+{
+public:
+    ~WorkerPool() { stop(); }
+
+    // Calls task(i) for every i in [0, count), spread over the workers and
+    // the caller, and returns once all calls are done. Not reentrant.
+    template <typename Fn>
+    void parallelFor(unsigned int count, Fn &&task)
+    {
+        using Task = std::remove_reference_t<Fn>;
+        run(count, [](void *context, unsigned int i)
+            { (*static_cast<Task *>(context))(i); }, const_cast<void *>(static_cast<const void *>(&task)));
+    }
+
+    // Workers plus the calling thread.
+    unsigned int concurrency() const { return std::max(1u, std::thread::hardware_concurrency()); }
+    void stop();
+
+private:
+    using TaskFunction = void (*)(void *, unsigned int);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    bool stopping = false;
+    uint64_t batch = 0;        // bumped per parallelFor, so workers see new work
+    unsigned int running = 0;  // workers not done with the current batch
+
+    TaskFunction taskFunction = nullptr;
+    void *taskContext = nullptr;
+    unsigned int taskCount = 0;
+    std::atomic<unsigned int> nextTask{0};
+
+    void run(unsigned int count, TaskFunction function, void *context);
+    void claimTasks();
+    void workerLoop();
+};
+
+extern WorkerPool workerPool;
+
+#endif
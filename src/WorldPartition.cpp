@@ -0,0 +1,176 @@
+#include "WorldPartition.h"
+#include "AssetLoader.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+void WorldPartition::configure(const ScenePartitionDescription &partitionSettings, SpawnFunction spawnFunction,
+                               DespawnFunction despawnFunction, SettledFunction settledFunction)
+{
+    settings = partitionSettings;
+    settings.cellSize = std::max(settings.cellSize, 1.0f);
+    if (settings.unloadRadius <= settings.loadRadius)
+    {
+        std::cerr << "Partition unloadRadius must exceed loadRadius; using loadRadius + cellSize" << std::endl;
+        settings.unloadRadius = settings.loadRadius + settings.cellSize;
+    }
+    settings.maxResidentCells = std::max(settings.maxResidentCells, 1);
+    spawn = std::move(spawnFunction);
+    despawn = std::move(despawnFunction);
+    settled = std::move(settledFunction);
+    enabled = true;
+}
+
+void WorldPartition::addEntity(const SceneEntityDescription &description)
+{
+    int x = static_cast<int>(std::floor(description.position.x / settings.cellSize));
+    int z = static_cast<int>(std::floor(description.position.z / settings.cellSize));
+    Cell &cell = cells[cellKey(x, z)];
+    cell.x = x;
+    cell.z = z;
+    cell.entities.push_back(description);
+}
+
+float WorldPartition::cellDistance(const Cell &cell, const glm::vec3 &position) const
+{
+    // Distance in XZ from the point to the cell's square footprint.
+    float minX = cell.x * settings.cellSize, minZ = cell.z * settings.cellSize;
+    float dx = std::max(std::max(minX - position.x, position.x - (minX + settings.cellSize)), 0.0f);
+    float dz = std::max(std::max(minZ - position.z, position.z - (minZ + settings.cellSize)), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+void WorldPartition::update(const glm::vec3 &cameraPosition, AssetLoader &loader)
+{
+    if (!enabled)
+        return;
+
+    // Release first, so the budget frees up for the cells now in range.
+    for (size_t i = 0; i < residentCells.size();)
+    {
+        Cell &cell = cells[residentCells[i]];
+        if (cellDistance(cell, cameraPosition) > settings.unloadRadius)
+        {
+            unloadCell(cell);
+            residentCells[i] = residentCells.back();
+            residentCells.pop_back();
+        }
+        else
+        {
+            if (cell.state == CELL_LOADING)
+                pollLoadingCell(cell);
+            ++i;
+        }
+    }
+
+    if (static_cast<int>(residentCells.size()) >= settings.maxResidentCells)
+        return;
+
+    // Only the cells overlapping the load radius are visited, not the whole world.
+    int x0 = static_cast<int>(std::floor((cameraPosition.x - settings.loadRadius) / settings.cellSize));
+    int x1 = static_cast<int>(std::floor((cameraPosition.x + settings.loadRadius) / settings.cellSize));
+    int z0 = static_cast<int>(std::floor((cameraPosition.z - settings.loadRadius) / settings.cellSize));
+    int z1 = static_cast<int>(std::floor((cameraPosition.z + settings.loadRadius) / settings.cellSize));
+
+    std::vector<std::pair<float, uint64_t>> candidates;
+    for (int z = z0; z <= z1; ++z)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            auto found = cells.find(cellKey(x, z));
+            if (found == cells.end() || found->second.state != CELL_UNLOADED)
+                continue;
+            float distance = cellDistance(found->second, cameraPosition);
+            if (distance <= settings.loadRadius)
+                candidates.emplace_back(distance, found->first);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    int requests = 0;
+    for (const auto &candidate : candidates)
+    {
+        if (static_cast<int>(residentCells.size()) >= settings.maxResidentCells || requests == MAX_REQUESTS_PER_UPDATE)
+            break;
+        requestCell(candidate.second, loader);
+        ++requests;
+    }
+}
+
+void WorldPartition::requestCell(uint64_t key, AssetLoader &loader)
+{
+    Cell &cell = cells[key];
+    cell.state = CELL_LOADING;
+    cell.pendingLoads = cell.entities.size();
+    cell.settledSpawns = 0;
+    cell.requestTime = std::chrono::steady_clock::now();
+    residentCells.push_back(key);
+
+    uint32_t generation = cell.generation;
+    for (size_t i = 0; i < cell.entities.size(); ++i)
+    {
+        const SceneEntityDescription &description = cell.entities[i];
+        // Meshes and textures are acquired by the spawn, shared with the
+        // entities already resident; only the material is per entity.
+        EntityAssetRequest request;
+        request.mtlFile = description.mtl;
+        loader.enqueue(request, [this, key, generation, i](EntityAssetData &data)
+                       { onEntityLoaded(key, generation, i, data); });
+    }
+    if (cell.entities.empty())
+        cell.state = CELL_LOADED;
+}
+
+void WorldPartition::onEntityLoaded(uint64_t key, uint32_t generation, size_t index, EntityAssetData &data)
+{
+    Cell &cell = cells[key];
+    if (cell.generation != generation)
+        return; // unloaded while in flight
+
+    cell.spawned.push_back(spawn(cell.entities[index], data));
+    --cell.pendingLoads;
+}
+
+void WorldPartition::pollLoadingCell(Cell &cell)
+{
+    if (cell.pendingLoads > 0)
+        return;
+    // Spawns settle roughly in order, so resume from the first one still pending.
+    while (cell.settledSpawns < cell.spawned.size() && settled(cell.spawned[cell.settledSpawns]))
+        ++cell.settledSpawns;
+    if (cell.settledSpawns < cell.spawned.size())
+        return;
+
+    cell.state = CELL_LOADED;
+    double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cell.requestTime).count();
+    totalLatencyMs += latency;
+    maxLatencyMs = std::max(maxLatencyMs, latency);
+    ++cellsLoaded;
+}
+
+void WorldPartition::unloadCell(Cell &cell)
+{
+    for (EntityHandle handle : cell.spawned)
+        despawn(handle);
+    cell.spawned.clear();
+    cell.spawned.shrink_to_fit();
+    cell.state = CELL_UNLOADED;
+    cell.pendingLoads = 0;
+    cell.settledSpawns = 0;
+    cell.generation++;
+    ++cellsUnloaded;
+}
+
+void WorldPartition::printStats() const
+{
+    if (!enabled)
+        return;
+    size_t loading = 0;
+    for (uint64_t key : residentCells)
+        if (cells.at(key).state == CELL_LOADING)
+            ++loading;
+    std::cout << "World partition: " << residentCells.size() << "/" << settings.maxResidentCells << " cells resident ("
+              << loading << " loading) of " << cells.size() << ", " << cellsLoaded << " loaded / " << cellsUnloaded
+              << " unloaded, latency avg " << (cellsLoaded ? totalLatencyMs / cellsLoaded : 0.0) << " ms max "
+              << maxLatencyMs << " ms" << std::endl;
+}
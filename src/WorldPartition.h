@@ -0,0 +1,87 @@
+#ifndef WORLD_PARTITION_H
+#define WORLD_PARTITION_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "EntityStore.h"
+#include "SceneStream.h"
+
+class AssetLoader;
+struct EntityAssetData;
+
+// Uniform XZ grid over the scene's entities. Only the descriptions of every
+// entity stay in memory; cells whose footprint comes within loadRadius of the
+// camera are loaded through the AssetLoader, and are unloaded once farther
+// than unloadRadius. At most maxResidentCells cells are loading or loaded at
+// a time, nearest first, which bounds memory regardless of the world size.
+// A cell counts as loaded once every entity has spawned and the shared
+// meshes, textures and trajectories they reference are READY or FAILED.
+class WorldPartition
+{
+public:
+    using SpawnFunction = std::function<EntityHandle(const SceneEntityDescription &, EntityAssetData &)>;
+    using DespawnFunction = std::function<void(EntityHandle)>;
+    // True once the entity's shared assets have finished loading (or failed).
+    using SettledFunction = std::function<bool(EntityHandle)>;
+
+    // Cells are spawned, despawned and polled through these; all run on the context thread.
+    void configure(const ScenePartitionDescription &settings, SpawnFunction spawn, DespawnFunction despawn,
+                   SettledFunction settled);
+    bool isEnabled() const { return enabled; }
+
+    void addEntity(const SceneEntityDescription &description);
+
+    // Requests and releases cells around the camera.
+    void update(const glm::vec3 &cameraPosition, AssetLoader &loader);
+
+    void printStats() const;
+
+private:
+    enum CellState
+    {
+        CELL_UNLOADED,
+        CELL_LOADING,
+        CELL_LOADED
+    };
+
+    struct Cell
+    {
+        int x = 0, z = 0;
+        std::vector<SceneEntityDescription> entities;
+        std::vector<EntityHandle> spawned;
+        CellState state = CELL_UNLOADED;
+        uint32_t generation = 0; // bumped on unload so late loads are dropped
+        size_t pendingLoads = 0;
+        size_t settledSpawns = 0; // spawned[0, settledSpawns) have all their assets
+        std::chrono::steady_clock::time_point requestTime;
+    };
+
+    // New cell requests per update, to spread the load over frames.
+    static constexpr int MAX_REQUESTS_PER_UPDATE = 4;
+
+    bool enabled = false;
+    ScenePartitionDescription settings;
+    SpawnFunction spawn;
+    DespawnFunction despawn;
+    SettledFunction settled;
+
+    std::unordered_map<uint64_t, Cell> cells;
+    std::vector<uint64_t> residentCells;
+
+    size_t cellsLoaded = 0, cellsUnloaded = 0;
+    double totalLatencyMs = 0.0, maxLatencyMs = 0.0;
+
+    static uint64_t cellKey(int x, int z) { return (uint64_t(uint32_t(x)) << 32) | uint32_t(z); }
+    float cellDistance(const Cell &cell, const glm::vec3 &position) const;
+    void requestCell(uint64_t key, AssetLoader &loader);
+    void onEntityLoaded(uint64_t key, uint32_t generation, size_t index, EntityAssetData &data);
+    // Marks a LOADING cell LOADED, and records its latency, once its assets have settled.
+    void pollLoadingCell(Cell &cell);
+    void unloadCell(Cell &cell);
+};
+
+#endif